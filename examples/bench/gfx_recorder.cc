@@ -0,0 +1,84 @@
+//
+// Stand-in for the sokol_gfx calls the sprite renderer makes. Buffers only track their append position so chunk
+// overflow behaves as it would on a GPU; nothing is drawn.
+//
+
+#include <sokol/sokol_gfx.h>
+
+#include <cstdint>
+#include <unordered_map>
+
+#include "gfx_recorder.hh"
+
+namespace {
+
+typedef struct {
+    size_t size;
+    size_t used;
+    uint64_t frame;
+} RecordedBuffer;
+
+std::unordered_map<uint32_t, RecordedBuffer> buffers;
+uint32_t next_id = 1;
+uint64_t frame = 0;
+
+RecordedBuffer& current(sg_buffer buf) {
+    RecordedBuffer& b = buffers.at(buf.id);
+    if (b.frame != frame) {
+        b.frame = frame;
+        b.used = 0;
+    }
+    return b;
+}
+
+} // namespace
+
+GfxRecord gfx_record = {};
+
+extern "C" {
+
+sg_backend sg_query_backend(void) { return SG_BACKEND_GLCORE; }
+
+sg_buffer sg_make_buffer(const sg_buffer_desc* desc) {
+    const uint32_t id = next_id++;
+    buffers[id] = {desc->size ? desc->size : desc->data.size, 0, UINT64_MAX};
+    return {id};
+}
+
+sg_image sg_make_image(const sg_image_desc*) { return {next_id++}; }
+sg_sampler sg_make_sampler(const sg_sampler_desc*) { return {next_id++}; }
+sg_shader sg_make_shader(const sg_shader_desc*) { return {next_id++}; }
+sg_pipeline sg_make_pipeline(const sg_pipeline_desc*) { return {next_id++}; }
+sg_view sg_make_view(const sg_view_desc*) { return {next_id++}; }
+void sg_destroy_image(sg_image) {}
+void sg_destroy_sampler(sg_sampler) {}
+void sg_destroy_view(sg_view) {}
+
+bool sg_query_buffer_will_overflow(sg_buffer buf, size_t size) {
+    const RecordedBuffer& b = current(buf);
+    return b.used + ((size + 3) & ~size_t{3}) > b.size;
+}
+
+int sg_append_buffer(sg_buffer buf, const sg_range* data) {
+    RecordedBuffer& b = current(buf);
+    const size_t offset = b.used;
+    b.used += (data->size + 3) & ~size_t{3};
+    gfx_record.bytes += data->size;
+    return static_cast<int>(offset);
+}
+
+void sg_apply_pipeline(sg_pipeline) {}
+void sg_apply_bindings(const sg_bindings*) {}
+void sg_apply_uniforms(int, const sg_range*) {}
+
+void sg_draw(int, int, int num_instances) {
+    gfx_record.draws++;
+    gfx_record.instances += static_cast<size_t>(num_instances);
+}
+
+void sg_commit(void) {
+    frame++;
+    gfx_record = {};
+}
+
+} // extern "C"
@@ -0,0 +1,15 @@
+//
+// What the stand-in sokol_gfx backend saw since the last sg_commit().
+//
+
+#pragma once
+
+#include <cstddef>
+
+typedef struct {
+    size_t bytes;      // appended to buffers
+    int draws;
+    size_t instances;  // summed over draws
+} GfxRecord;
+
+extern GfxRecord gfx_record;
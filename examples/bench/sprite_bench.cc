@@ -0,0 +1,197 @@
+//
+// CPU cost and upload size of the sprite renderer, run against gfx_recorder.cc instead of a GPU:
+//   layout      bytes uploaded per frame by the Standard and Compact instance layouts
+//   sort        render() of sprites pushed with mixed Orders against the same sprites pushed in draw order
+//   push_many   one push() per sprite against a single push_many()
+//   recorders   pushing from 1, 2, 4 and 8 threads through Renderer::recorder(), and the render() merging them
+//   culling     render() of a scene mostly off screen, with and without culling
+// Every figure is the median of a few frames. Usage: sprite_bench [sprites]
+//
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <functional>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <stb_image_write.h>
+
+#include <sokol/sokol_gfx.h>
+
+#include "sprite.hh"
+#include "device.hh"
+
+#include "gfx_recorder.hh"
+
+using namespace Asura;
+
+enum class Img { A = 1, B, C };
+
+static constexpr int FRAMES = 7;
+
+// What Asura::end() does once the frame's passes are recorded.
+static void end_frame() {
+    sg_commit();
+    ++Device::instance().frame;
+}
+
+static double median(std::vector<double> ms) {
+    std::sort(ms.begin(), ms.end());
+    return ms[ms.size() / 2];
+}
+
+static double since_ms(std::chrono::steady_clock::time_point t0) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+}
+
+static double median_ms(const std::function<void()>& frame) {
+    std::vector<double> ms;
+    frame();   // warm up, so chunk and scratch allocations aren't timed
+    for (int i = 0; i < FRAMES; ++i) {
+        const auto t0 = std::chrono::steady_clock::now();
+        frame();
+        ms.push_back(since_ms(t0));
+    }
+    return median(ms);
+}
+
+// Three noisy 64x48 sprites, so trimming and packing have something to do.
+static std::filesystem::path write_images() {
+    const auto dir = std::filesystem::temp_directory_path() / "asura_sprite_bench";
+    std::filesystem::create_directories(dir);
+    std::mt19937 rng(7);
+    std::vector<unsigned char> px(64 * 48 * 4);
+    for (const char* name : {"a", "b", "c"}) {
+        for (auto& p : px) p = static_cast<unsigned char>(rng());
+        stbi_write_png((dir / (std::string(name) + ".png")).string().c_str(), 64, 48, 4, px.data(), 64 * 4);
+    }
+    return dir;
+}
+
+typedef struct {
+    std::vector<Img> ids;
+    std::vector<Math::Vec2> positions;
+    std::vector<Math::Vec2> scales;
+    std::vector<float> rotations;
+    std::vector<Math::Vec4> tints;
+    std::vector<Sprite::Order> orders;
+} Scene;
+
+// Sprites spread over `spread` times the screen in each direction, centred on it.
+static Scene make_scene(int n, float spread) {
+    Scene s;
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> x(800.f * (0.5f - spread / 2), 800.f * (0.5f + spread / 2));
+    std::uniform_real_distribution<float> y(600.f * (0.5f - spread / 2), 600.f * (0.5f + spread / 2));
+    std::uniform_real_distribution<float> unit(0.f, 1.f);
+    for (int i = 0; i < n; ++i) {
+        s.ids.push_back(static_cast<Img>(1 + i % 3));
+        s.positions.push_back({x(rng), y(rng)});
+        s.scales.push_back({0.5f + unit(rng), 0.5f + unit(rng)});
+        s.rotations.push_back(unit(rng) * 6.283f);
+        s.tints.push_back({1.f, unit(rng), unit(rng), 1.f});
+        s.orders.push_back({static_cast<uint16_t>(rng() % 4), unit(rng),
+                            rng() % 2 ? Sprite::Blend::Additive : Sprite::Blend::Alpha});
+    }
+    return s;
+}
+
+static void push_scene(Sprite::Renderer& sr, const Scene& s, bool ordered) {
+    for (size_t i = 0; i < s.ids.size(); ++i) {
+        const sg_color tint = {s.tints[i].x, s.tints[i].y, s.tints[i].z, s.tints[i].w};
+        if (ordered) sr.push(s.ids[i], s.orders[i], s.positions[i], s.scales[i], s.rotations[i], tint, Sprite::Pivot::Centre());
+        else sr.push(s.ids[i], s.positions[i], s.scales[i], s.rotations[i], tint, Sprite::Pivot::Centre());
+    }
+}
+
+static void init_renderer(Sprite::Renderer& sr, const std::filesystem::path& dir, Sprite::InstanceLayout layout) {
+    sr.init(dir.string(), {{"a", 1, 0}, {"b", 2, 0}, {"c", 3, 0}}, layout);
+    sr.resize({800, 600}, {800, 600});
+}
+
+int main(int argc, char** argv) {
+    const int n = argc > 1 ? std::atoi(argv[1]) : 100000;
+    Device::instance().init(800, 600, "sprite_bench");
+    const auto dir = write_images();
+    const Scene scene = make_scene(n, 1.f);
+
+    Sprite::Renderer standard, compact;
+    init_renderer(standard, dir, Sprite::InstanceLayout::Standard);
+    init_renderer(compact, dir, Sprite::InstanceLayout::Compact);
+
+    for (auto [name, sr] : {std::pair{"standard", &standard}, std::pair{"compact", &compact}}) {
+        push_scene(*sr, scene, false);
+        sr->render();
+        std::printf("layout     %-9s %d sprites: %zu bytes/frame, %.1f per sprite, %d draws\n", name, n,
+                    gfx_record.bytes, double(gfx_record.bytes) / n, gfx_record.draws);
+        end_frame();
+    }
+
+    for (bool ordered : {false, true}) {
+        const double ms = median_ms([&] { push_scene(standard, scene, ordered); standard.render(); end_frame(); });
+        push_scene(standard, scene, ordered);
+        standard.render();
+        std::printf("sort       %-9s %d sprites: %.2f ms push+render, %d draws\n", ordered ? "4 layers" : "unsorted",
+                    n, ms, gfx_record.draws);
+        end_frame();
+    }
+
+    const double push_ms = median_ms([&] {
+        for (size_t i = 0; i < scene.ids.size(); ++i)
+            standard.push(scene.ids[i], scene.positions[i], scene.scales[i], scene.rotations[i], scene.tints[i], Sprite::Pivot::Centre());
+        standard.render();
+        end_frame();
+    });
+    const double many_ms = median_ms([&] {
+        standard.push_many<Img>(scene.ids, scene.positions, scene.scales, scene.rotations, scene.tints, Sprite::Pivot::Centre());
+        standard.render();
+        end_frame();
+    });
+    std::printf("push_many  %d sprites: %.2f ms push()+render, %.2f ms push_many()+render\n", n, push_ms, many_ms);
+
+    // the threads only share the pushing, render() merges and uploads on the calling thread, so they are timed apart
+    for (int threads : {1, 2, 4, 8}) {
+        for (int t = 0; t < threads; ++t) standard.recorder(t);
+        std::vector<double> push_ms, render_ms;
+        for (int frame = 0; frame <= FRAMES; ++frame) {
+            const auto t0 = std::chrono::steady_clock::now();
+            std::vector<std::thread> workers;
+            for (int t = 0; t < threads; ++t) workers.emplace_back([&, t] {
+                Sprite::Recorder& rec = standard.recorder(t);
+                for (int i = t * n / threads; i < (t + 1) * n / threads; ++i)
+                    rec.push(scene.ids[i], scene.positions[i], scene.scales[i], scene.rotations[i], sg_white, Sprite::Pivot::Centre());
+            });
+            for (auto& w : workers) w.join();
+            const double pushed = since_ms(t0);
+
+            const auto t1 = std::chrono::steady_clock::now();
+            standard.render();
+            end_frame();
+            if (frame == 0) continue;   // warm up
+            push_ms.push_back(pushed);
+            render_ms.push_back(since_ms(t1));
+        }
+        std::printf("recorders  %d thread(s) on %u core(s) %d sprites: %.2f ms push, %.2f ms render\n", threads,
+                    std::thread::hardware_concurrency(), n, median(push_ms), median(render_ms));
+    }
+
+    const Scene wide = make_scene(n, 10.f);
+    for (bool culling : {false, true}) {
+        standard.set_culling(culling);
+        const double ms = median_ms([&] { push_scene(standard, wide, false); standard.render(); end_frame(); });
+        push_scene(standard, wide, false);
+        standard.render();
+        std::printf("culling    %-3s %d sprites over 10x the screen: %.2f ms push+render, %zu drawn, %zu bytes\n",
+                    culling ? "on" : "off", n, ms, gfx_record.instances, gfx_record.bytes);
+        end_frame();
+    }
+    standard.set_culling(false);
+
+    std::filesystem::remove_all(dir);
+    return 0;
+}
@@ -4,6 +4,9 @@
 
 #pragma once
 
+#include <bit>
+#include <cstdint>
+
 /* General Math Functions */
 
 namespace Asura::Math {
@@ -18,4 +21,31 @@ inline double degrees(double rad) {
     return rad * 180.f / pi;
 }
 
+// Float to IEEE 754 half (binary16), round to nearest even. Used for packing SG_VERTEXFORMAT_HALF2/HALF4 data.
+inline std::uint16_t to_half(float f) {
+    const std::uint32_t x    = std::bit_cast<std::uint32_t>(f);
+    const std::uint32_t sign = (x >> 16) & 0x8000u;
+    const std::uint32_t e    = (x >> 23) & 0xffu;
+    std::uint32_t mant       = x & 0x7fffffu;
+    const int exp            = static_cast<int>(e) - 127 + 15;
+
+    if (e == 0xff) return static_cast<std::uint16_t>(sign | 0x7c00u | (mant ? 0x200u : 0u));  // inf/nan
+    if (exp >= 31) return static_cast<std::uint16_t>(sign | 0x7c00u);                          // overflow
+    if (exp <= 0) {
+        // subnormal half (or zero)
+        if (exp < -10) return static_cast<std::uint16_t>(sign);
+        mant |= 0x800000u;
+        const std::uint32_t shift = static_cast<std::uint32_t>(14 - exp);
+        std::uint32_t h = mant >> shift;
+        const std::uint32_t rem = mant & ((1u << shift) - 1u), halfway = 1u << (shift - 1u);
+        if (rem > halfway || (rem == halfway && (h & 1u))) ++h;
+        return static_cast<std::uint16_t>(sign | h);
+    }
+
+    std::uint32_t h = sign | (static_cast<std::uint32_t>(exp) << 10) | (mant >> 13);
+    const std::uint32_t rem = mant & 0x1fffu;
+    if (rem > 0x1000u || (rem == 0x1000u && (h & 1u))) ++h;  // a carry into the exponent is still correct
+    return static_cast<std::uint16_t>(h);
+}
+
 }
\ No newline at end of file
@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include <algorithm>
+#include <cstdint>
 #include <iostream>
 #include <string>
 #include <filesystem>
@@ -13,6 +15,7 @@
 namespace fs = std::filesystem;
 
 #include <nlohmann/json.hpp>
+#include <sokol/sokol_gfx.h>
 
 #include "log.h"
 #include "result.hh"
@@ -211,4 +214,14 @@ inline static void update_projection_matrix(Math::Vec2 dim, Math::Vec2 virtual_d
     projection = proj * model;
 }
 
+// A colour as four bytes, red lowest, the way UBYTE4N vertex attributes read it. Components are clamped to [0, 1].
+inline uint32_t rgba8(Math::Vec4 c) {
+    auto b = [](float v) { return static_cast<uint32_t>(std::clamp(v, 0.f, 1.f) * 255.f + 0.5f); };
+    return b(c.x) | (b(c.y) << 8) | (b(c.z) << 16) | (b(c.w) << 24);
+}
+
+inline uint32_t rgba8(sg_color c) {
+    return rgba8(Math::Vec4(c.r, c.g, c.b, c.a));
+}
+
 } // Asura::Utils::Gfx
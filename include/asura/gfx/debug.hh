@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <span>
 #include <string>
 #include <vector>
 
@@ -27,6 +28,27 @@ public:
     static void print(const std::vector<std::string>& text, const std::string& label = "", sg_color color = sg_white, int font = FONT_ORIC);
     static void temp(const std::vector<std::string>& text, float lifespan, float dt, const std::string& label = "", sg_color color = sg_white, int font = FONT_ORIC);
 
+    /*
+     * Primitives go into one vertex stream for the frame and are drawn by Asura::end() over everything else, in one
+     * draw for lines and one for filled shapes. Points are in the same pixels as sprites and text, moved by view().
+     * line3d() and aabb3d() are world space instead, drawn in a third draw with the matrix given to view_projection().
+     */
+    static void line(Math::Vec2 a, Math::Vec2 b, sg_color color = sg_white);
+    static void line3d(Math::Vec3 a, Math::Vec3 b, sg_color color = sg_white);
+    static void lines(std::span<const Math::Vec2> points, sg_color color = sg_white);  // a segment per pair of points
+    static void rect(Math::Vec2 pos, Math::Vec2 size, sg_color color = sg_white, bool filled = false);
+    static void circle(Math::Vec2 centre, float radius, sg_color color = sg_white, bool filled = false, int segments = 32);
+    static void arrow(Math::Vec2 from, Math::Vec2 to, sg_color color = sg_white, float head = 8.f);
+    static void aabb(Math::Vec2 min, Math::Vec2 max, sg_color color = sg_white);
+    static void aabb3d(Math::Vec3 min, Math::Vec3 max, sg_color color = sg_white);  // its 12 edges
+    static void view(Math::Mat4 view);  // applied to the primitives of every frame after, like Renderer::render(view)
+    static void view_projection(Math::Mat4 view_projection);  // the 3D camera, for line3d() and aabb3d(); identity until set
+
     static void resize(Math::Vec2 dim);
+    static void resize(Math::Vec2 dim, Math::Vec2 virtual_dim);  // primitives only, to match sprites and text
+
+    // Called by Asura::init() and Asura::end() when debugging is enabled.
+    static void init_primitives();
+    static void draw_primitives();
 };
 } // Asura
\ No newline at end of file
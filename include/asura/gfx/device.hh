@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <cstdint>
 #include <string>
 #include <functional>
 
@@ -73,6 +74,13 @@ public:
     bool debug = false;
     int debug_scale = 1;
 
+    /*
+     * Frames finished so far, bumped by Asura::end() after sg_commit(). Renderers compare it with the frame of their
+     * last render() to tell a new frame from another render() in the same one. Code that commits without Asura::end()
+     * has to bump it too.
+     */
+    uint64_t frame = 0;
+
 private:
     Device() = default;
 };
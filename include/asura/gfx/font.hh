@@ -11,7 +11,10 @@
 #include "../core/math.hh"
 #include "../core/utils.h"
 
+#include <array>
+#include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include <sokol/sokol_gfx.h>
@@ -19,74 +22,254 @@
 
 #include "shaders/shader.glsl.h"
 
+// stb_truetype uses the real rect packer when it is included first
+#include <stb_rect_pack.h>
 #include <stb_truetype.h>
 
-static constexpr int FIRST_CHAR = 32;  // start with ASCII code 33 exclamation mark.
-static constexpr int NUM_CHARS  = 95;  // end with ASCII code 127
+// Glyphs rasterized when a font is baked and kept in its atlas for good; everything else is rasterized on first use.
+static constexpr int FIRST_CHAR = 32;  // start with ASCII code 32 space.
+static constexpr int NUM_CHARS  = 95;  // end with ASCII code 126 tilde
+
+/*
+ * The glyph atlas starts just big enough for the baked glyphs of every font and doubles up to this size per side, after
+ * which the least recently used glyphs are evicted.
+ */
+static constexpr int MAX_GLYPH_ATLAS = 2048;
+
+// Most a bitmap font can be oversampled horizontally, as stb_truetype allows.
+static constexpr int MAX_OVERSAMPLE = 8;
+
+// Texels of distance field around every SDF glyph, the most an outline can be pushed out by.
+static constexpr int SDF_PADDING = 6;
 
 namespace Asura::Font {
-struct Vertex {
-    float x, y;
-    float u, v;
-    Math::Vec4 color;
+/*
+ * How glyphs are stored in the glyph atlas.
+ * Bitmap: coverage at the registered size, crisp at that size only.
+ * SDF:    distance to the outline, so one bake stays sharp from a fraction of its size to several times it.
+ *         Register SDF fonts at around 32-48px.
+ */
+enum class GlyphFormat : uint32_t {
+    Bitmap,
+    SDF
 };
 
-struct Font {
-    int id;
-    std::string name;
-    int size;
+// One glyph on screen, stretched over a unit quad by vs_text: 28 bytes where four vertices and six indices took 140.
+struct GlyphInstance {
+    float x, y, w, h;          // screen rect
+    uint16_t u0, v0, u1, v1;   // atlas rect, normalized to 65535
+    uint32_t color;            // RGBA8, red in the low byte
+};
+
+struct Glyph {
+    int x, y, w, h;       // rect in the atlas, empty for blank glyphs like space
+    float xoff, yoff;     // bitmap offset from the pen position, in pixels
+    float advance;
+    uint64_t used;        // last frame the glyph was pushed in
+    bool pinned;          // baked up front, never evicted
+    int refs;             // retained texts showing it, not evicted while any are left
+};
+
+// Glyphs of every font share one atlas, told apart by the index of their font.
+constexpr uint64_t glyph_key(int font, uint32_t codepoint) {
+    return static_cast<uint64_t>(static_cast<uint32_t>(font)) << 32 | codepoint;
+}
 
+// A glyph pushed this frame; its uvs are looked up at render(), as the atlas can be repacked in between.
+struct GlyphQuad {
+    float x0, y0, x1, y1;
+    uint64_t glyph;  // glyph_key()
+    uint32_t color;
+};
+
+// Glyphs of all fonts packed into one R8 atlas, growing and evicting as text asks for new ones.
+struct GlyphAtlas {
+    std::unordered_map<uint64_t, Glyph> glyphs;
     int w, h;
     std::vector<std::uint8_t> bitmap;
+    stbrp_context packer;
+    std::vector<stbrp_node> nodes;
+    bool dirty;      // pixels changed since the last upload
+    bool resized;    // the atlas image has to be made again
+    uint64_t uploaded;  // Device::frame + 1 at the last upload, sokol takes one update per image per frame
+    uint64_t layout;    // bumped by every repack, as glyphs may have moved
+    int evictions;
 
-    sg_image atlas;  // font texture
+    sg_image image;
     sg_view view;
-    std::array<stbtt_bakedchar, NUM_CHARS> chars;
+};
 
-    // per frame batch for this font
-    struct {
-        std::vector<Vertex> verts;
-        std::vector<uint16_t> indices;
-    } batch;
+// A string laid out once, see Renderer::retain(). The generation tells a released slot from its next owner.
+struct TextHandle {
+    uint32_t index = UINT32_MAX;
+    uint32_t generation = 0;
+};
+
+struct RetainedText {
+    int font;
+    std::string text;
+    float scale;
+    uint32_t color;
+    std::vector<GlyphQuad> quads;  // relative to the text origin
+    sg_buffer buf;                 // instances, made again when the text changes or the atlas is repacked
+    int count;
+    uint64_t layout;               // atlas layout the uvs in buf were resolved against
+    uint32_t generation;
+    bool live;
+};
+
+// A string laid out by Renderer::_shape(), kept in its layout cache.
+struct TextRun {
+    struct Pen {
+        uint32_t codepoint;
+        float x, y;  // unscaled pixels from the text origin
+    };
+    std::vector<Pen> pens;
+    Math::Vec2 size;   // scaled, see Renderer::measure()
+    uint64_t used;     // last frame it was asked for
+
+    // what it was laid out from, telling hash collisions apart
+    int font;
+    float scale, width;
+    std::string text;
+};
+
+struct Font {
+    int id;
+    int index;  // in Renderer::fonts, keys its glyphs
+    std::string name;
+    int size;
+
+    std::shared_ptr<const std::vector<std::uint8_t>> ttf;  // shared by every size of a face, kept for glyphs rasterized after the bake
+    stbtt_fontinfo info;
+    float scale;                     // stbtt scale for size
+    int oversample;                  // horizontal, glyphs are this many times wider in the atlas than on screen
+
+    // the baked range, so laying out ASCII never reaches into stbtt
+    std::array<float, NUM_CHARS> advance;
+    std::vector<float> kerning;      // NUM_CHARS x NUM_CHARS, first character major
 };
 
 class Renderer {
 public:
-    void init(const std::string& fonts_dir, std::vector<ResourceDef> reg = {});
+    /*
+     * Registering a face more than once with different sizes bakes every size from one copy of the TTF. Bitmap fonts can
+     * be oversampled horizontally, up to MAX_OVERSAMPLE, so small text placed at fractional pixels stays smooth.
+     */
+    void init(const std::string& fonts_dir, std::vector<ResourceDef> reg = {}, GlyphFormat format = GlyphFormat::Bitmap, int oversample = 1);
      template <typename E>
         requires std::is_enum_v<E>
     void push(E id, std::string_view text, Math::Vec2 pos, float scale = 1.f, sg_color tint = sg_white) {
-        _push_text(std::to_underlying(id), text, pos, scale, tint);
+        _push_text(std::to_underlying(id), text, pos, 0.f, scale, tint);
+    }
+
+    // Wraps at spaces to stay within max_width pixels, breaking words that don't fit a line on their own.
+    template <typename E>
+        requires std::is_enum_v<E>
+    void push_wrapped(E id, std::string_view text, Math::Vec2 pos, float max_width, float scale = 1.f, sg_color tint = sg_white) {
+        _push_text(std::to_underlying(id), text, pos, max_width, scale, tint);
+    }
+
+    // Size of text as push() or, with a max_width above 0, push_wrapped() would lay it out, in pixels.
+    template <typename E>
+        requires std::is_enum_v<E>
+    Math::Vec2 measure(E id, std::string_view text, float scale = 1.f, float max_width = 0.f) {
+        return _measure(std::to_underlying(id), text, scale, max_width);
     }
 
+    /*
+     * Draws everything pushed since the last render(), whatever its font, in one draw call, and uploads glyphs
+     * rasterized since the last upload. Text is UTF-8; glyphs outside the baked ASCII range are rasterized the first
+     * time they are pushed. Sokol updates an image once per frame, so when an earlier render() this frame already
+     * uploaded, new glyphs cost a fresh atlas image and a full upload; push text with new glyphs before the first
+     * render() of a frame where that matters.
+     */
     void render(Math::Mat4 view = Math::Mat4(1.f));
 
+    /*
+     * Lays text out once into a GPU buffer of its own, for labels that look the same every frame. draw() then shows
+     * it with no layout or upload, and only set_text() with a different string lays it out again.
+     */
+    template <typename E>
+        requires std::is_enum_v<E>
+    TextHandle retain(E id, std::string_view text, float scale = 1.f, sg_color tint = sg_white) {
+        return _retain(std::to_underlying(id), text, scale, tint);
+    }
+    void set_text(TextHandle handle, std::string_view text);
+    void draw(TextHandle handle, Math::Vec2 pos);  // by the next render(), under the text pushed for it
+    void release(TextHandle handle);
+
     void resize(Math::Vec2 dim, Math::Vec2 virtual_dim) { Utils::Gfx::update_projection_matrix(dim, virtual_dim, vs_params.mvp); }
 
+    // Debugging aid: the shared glyph atlas as a greyscale PNG. init() no longer writes one.
+    void write_atlas_png(const std::string& path) const;
+
 private:  
     void _clear();
 
     void _init_fonts(const char* dir);
     void _init_fr();
 
-    void _push_text(int id, std::string_view text, Math::Vec2 pos, float scale, sg_color tint);
+    void _push_text(int id, std::string_view text, Math::Vec2 pos, float width, float scale, sg_color tint);
+    Math::Vec2 _measure(int id, std::string_view text, float scale, float width);
+    const TextRun& _shape(const Font& font, std::string_view text, float scale, float width);
+    void _layout(Font& font, const TextRun& run, Math::Vec2 pos, float scale, uint32_t color, std::vector<GlyphQuad>& out);
+    void _resolve(const std::vector<GlyphQuad>& in, std::vector<GlyphInstance>& out) const;
+
+    TextHandle _retain(int id, std::string_view text, float scale, sg_color tint);
+    RetainedText* _retained(TextHandle handle);
+    void _ref(const std::vector<GlyphQuad>& glyphs, int delta);
+    void _build(RetainedText& text);
 
     Font* _find_font(int id);
 
-    // remove
-    std::array<stbtt_bakedchar, NUM_CHARS> char_data = {};
-    
+    const Glyph* _glyph(Font& font, uint32_t codepoint, bool pinned = false);
+    const Glyph* _place(const Font& font, uint32_t codepoint, Glyph g, const std::uint8_t* pixels);
+    bool _make_room();
+    void _upload();
+    bool _new_frame();
+    void _grow_chunks(size_t count);
+
     std::vector<ResourceDef> kFontDefs;
     std::vector<Font> fonts;
 
+    std::unique_ptr<GlyphAtlas> atlas;  // the packer points into itself, so it stays put
+
+    // per frame batch for all fonts
+    std::vector<GlyphQuad> quads;
+    std::vector<GlyphInstance> instances;
+
+    struct RetainedDraw {
+        uint32_t index;
+        Math::Vec2 pos;
+    };
+    std::vector<RetainedText> retained;
+    std::vector<uint32_t> free_retained;
+    std::vector<RetainedDraw> retained_draws;
+
+    // Runs by (font, scale, width, text) hash. Past this many, render() drops those not asked for that frame.
+    static constexpr size_t MAX_CACHED_LAYOUTS = 1024;
+    std::unordered_map<uint64_t, TextRun> layouts;
+
     std::array<int, 256> id_to_font_index = {};
 
-    sg_buffer   vbuf = {};
+    sg_buffer   qbuf = {};  // unit quad
     sg_buffer   ibuf = {};
     sg_pipeline pip  = {};
     sg_sampler  smp  = {};
 
-    static constexpr int MAX_GLYPHS = 4096;
+    // Instances stream into fixed size chunks, and another chunk is made whenever a frame fills the ones there are.
+    static constexpr size_t GLYPHS_PER_CHUNK = 16384;
+    std::vector<sg_buffer> chunks;
+    struct {
+        size_t chunk;  // being appended to
+        size_t used;   // instances in it this frame
+    } ring = {};
+
+    uint64_t frame = 0;  // render() calls so far, stamps Glyph::used
+    uint64_t drawn_frame = UINT64_MAX;  // Device::frame at the last render() that appended
+    GlyphFormat format = GlyphFormat::Bitmap;
+    int oversample = 1;
 
     text_params_t vs_params;
 };
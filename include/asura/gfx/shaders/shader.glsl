@@ -1,5 +1,6 @@
 @header #include "../../core/math.hh"
 @ctype mat4 Asura::Math::Mat4
+@ctype vec4 Asura::Math::Vec4
 
 @vs vs_inst
 
@@ -7,34 +8,41 @@ layout(binding = 0) uniform instance_params {
     mat4 mvp;
 };
 
+// Uploaded once at init, instances only carry an index into frames.
+layout(binding = 1) uniform instance_frames {
+    vec4 atlas_size;     // xy = atlas size in pixels
+    vec4 frames[128];    // per sprite id: xy = uv offset, zw = uv scale
+};
+
 in vec2 aPos;
 in vec2 aUV;
-in vec2 aOffset;
-in vec2 aUVOffset;
-in vec2 aWorldScale;
-in vec2 aUVScale;
-in float aRotation;
-in vec2 aPivot;
+in vec2 aOffset;     // pivot is already applied on the CPU
+in vec4 aScaleRot;   // xy = scale, z = rotation, w = sprite id + 128 * palette row
 in vec4 aTint;
 
 out vec2 vUV;
 out vec4 vTint;
+out float vPalette;
 
 void main() {
-    float c = cos(aRotation);
-    float s = sin(aRotation);
+    int packed = int(aScaleRot.w);
+    vec4 frame = frames[packed % 128];
+    vec2 world_scale = frame.zw * atlas_size.xy * aScaleRot.xy;
+
+    float c = cos(aScaleRot.z);
+    float s = sin(aScaleRot.z);
     mat2 rot = mat2(c, -s, s, c);
 
-    vec2 p = aPos - aPivot;
-    vec2 scaled = p * aWorldScale;
+    vec2 scaled = aPos * world_scale;
     vec2 rotated = rot * scaled;
 
     vec2 world_xy = rotated + aOffset;
     gl_Position = mvp * vec4(world_xy, 0.0, 1.0);
     
-    vUV = aUVOffset + (aUV * aUVScale);
+    vUV = frame.xy + (aUV * frame.zw);
 
     vTint = aTint;
+    vPalette = float(packed / 128);
 }
 @end
 
@@ -43,6 +51,7 @@ out vec4 FragColor;
 
 in vec2 vUV;
 in vec4 vTint;
+in float vPalette;
 
 layout(binding = 0) uniform texture2D inst_tex;
 layout(binding = 0) uniform sampler inst_smp;
@@ -53,7 +62,28 @@ void main() {
 }
 @end
 
+// Indexed atlas: the page holds palette indices, the colour comes from row vPalette of the palette texture.
+@fs fs_inst_indexed
+out vec4 FragColor;
+
+in vec2 vUV;
+in vec4 vTint;
+in float vPalette;
+
+layout(binding = 0) uniform texture2D inst_tex;
+layout(binding = 1) uniform texture2D inst_palette;
+layout(binding = 0) uniform sampler inst_smp;
+#define inst_texture sampler2D(inst_tex, inst_smp)
+#define palette_texture sampler2D(inst_palette, inst_smp)
+
+void main() {
+    int index = int(texture(inst_texture, vUV).r * 255.0 + 0.5);
+    FragColor = vTint * texelFetch(palette_texture, ivec2(index, int(vPalette + 0.5)), 0);
+}
+@end
+
 @program instance vs_inst fs_inst
+@program instance_indexed vs_inst fs_inst_indexed
 
 @vs vs_text
 
@@ -61,16 +91,18 @@ layout(binding = 0) uniform text_params {
     mat4 mvp;
 };
 
-in vec2 position;
-in vec2 texcoord0;
+// One instance per glyph, stretched over a unit quad.
+in vec2 corner;      // 0..1
+in vec4 rect;        // xy = top left, zw = size, in pixels
+in vec4 uv_rect;     // xy = top left, zw = bottom right, in atlas uvs
 in vec4 color0;
 
 out vec2 uv;
 out vec4 color;
 
 void main() {
-    gl_Position = mvp * vec4(position, 0.0, 1.0);  // if pass already in clip space?
-    uv = texcoord0;
+    gl_Position = mvp * vec4(rect.xy + corner * rect.zw, 0.0, 1.0);
+    uv = mix(uv_rect.xy, uv_rect.zw, corner);
     color = color0;
 }
 @end
@@ -90,4 +122,52 @@ void main() {
 }
 @end
 
-@program text vs_text fs_text
\ No newline at end of file
+@program text vs_text fs_text
+// Signed distance field glyphs: 0.5 is the outline, fwidth keeps the edge about a pixel wide at any scale.
+@fs fs_text_sdf
+layout(binding = 1) uniform texture2D text_tex;
+layout(binding = 1) uniform sampler text_smp;
+#define text_texture sampler2D(text_tex, text_smp)
+
+in vec2 uv;
+in vec4 color;
+out vec4 frag_color;
+
+void main() {
+    float dist = texture(text_texture, uv).r;
+    float edge = fwidth(dist) * 0.5;
+    float alpha = smoothstep(0.5 - edge, 0.5 + edge, dist);
+    frag_color = vec4(color.rgb, color.a * alpha);
+}
+@end
+
+@program text_sdf vs_text fs_text_sdf
+
+// Debug primitives, one vertex per line end or triangle corner.
+@vs vs_prim
+
+layout(binding = 0) uniform prim_params {
+    mat4 mvp;
+};
+
+in vec3 position;
+in vec4 color0;
+
+out vec4 color;
+
+void main() {
+    gl_Position = mvp * vec4(position, 1.0);
+    color = color0;
+}
+@end
+
+@fs fs_prim
+in vec4 color;
+out vec4 frag_color;
+
+void main() {
+    frag_color = color;
+}
+@end
+
+@program prim vs_prim fs_prim
@@ -1,9 +1,11 @@
 #pragma once
 #include "../../core/math.hh"
 /*
-    #version:1# (machine generated, don't edit!)
-
-    Generated by sokol-shdc (https://github.com/floooh/sokol-tools)
+    NOT sokol-shdc output. This is a hand-assembled stand-in for it that only carries
+    the GLSL backend, following shader.glsl; HLSL and Metal were never compiled and are
+    left out, so D3D11 and Metal builds stop at Asura::init(). Regenerate it with
+    sokol-shdc (https://github.com/floooh/sokol-tools) through the asura_shaders target
+    (see CMakeLists.txt) and commit that output unmodified.
 
     Cmdline:
         sokol-shdc -i ../include/asura/gfx/shaders/shader.glsl -o ../include/asura/gfx/shaders/shader.glsl.h -l glsl410:hlsl5:metal_macos
@@ -18,32 +20,66 @@
             ATTR_instance_aPos => 0
             ATTR_instance_aUV => 1
             ATTR_instance_aOffset => 2
-            ATTR_instance_aUVOffset => 3
-            ATTR_instance_aWorldScale => 4
-            ATTR_instance_aUVScale => 5
-            ATTR_instance_aRotation => 6
-            ATTR_instance_aPivot => 7
-            ATTR_instance_aTint => 8
+            ATTR_instance_aScaleRot => 3
+            ATTR_instance_aTint => 4
+    Shader program: 'instance_indexed':
+        Get shader desc: instance_indexed_shader_desc(sg_query_backend());
+        Vertex Shader: vs_inst
+        Fragment Shader: fs_inst_indexed
+        Attributes:
+            ATTR_instance_indexed_aPos => 0
+            ATTR_instance_indexed_aUV => 1
+            ATTR_instance_indexed_aOffset => 2
+            ATTR_instance_indexed_aScaleRot => 3
+            ATTR_instance_indexed_aTint => 4
     Shader program: 'text':
         Get shader desc: text_shader_desc(sg_query_backend());
         Vertex Shader: vs_text
         Fragment Shader: fs_text
         Attributes:
-            ATTR_text_position => 0
-            ATTR_text_texcoord0 => 1
-            ATTR_text_color0 => 2
+            ATTR_text_corner => 0
+            ATTR_text_rect => 1
+            ATTR_text_uv_rect => 2
+            ATTR_text_color0 => 3
+    Shader program: 'text_sdf':
+        Get shader desc: text_sdf_shader_desc(sg_query_backend());
+        Vertex Shader: vs_text
+        Fragment Shader: fs_text_sdf
+        Attributes:
+            ATTR_text_sdf_corner => 0
+            ATTR_text_sdf_rect => 1
+            ATTR_text_sdf_uv_rect => 2
+            ATTR_text_sdf_color0 => 3
+    Shader program: 'prim':
+        Get shader desc: prim_shader_desc(sg_query_backend());
+        Vertex Shader: vs_prim
+        Fragment Shader: fs_prim
+        Attributes:
+            ATTR_prim_position => 0
+            ATTR_prim_color0 => 1
     Bindings:
         Uniform block 'instance_params':
             C struct: instance_params_t
             Bind slot: UB_instance_params => 0
+        Uniform block 'instance_frames':
+            C struct: instance_frames_t
+            Bind slot: UB_instance_frames => 1
         Uniform block 'text_params':
             C struct: text_params_t
             Bind slot: UB_text_params => 0
+        Uniform block 'prim_params':
+            C struct: prim_params_t
+            Bind slot: UB_prim_params => 0
         Texture 'inst_tex':
             Image type: SG_IMAGETYPE_2D
             Sample type: SG_IMAGESAMPLETYPE_FLOAT
             Multisampled: false
             Bind slot: VIEW_inst_tex => 0
+        Texture 'inst_palette':
+            Image type: SG_IMAGETYPE_2D
+            Sample type: SG_IMAGESAMPLETYPE_FLOAT
+            Multisampled: false
+            Bind slot: VIEW_inst_palette => 1
         Texture 'text_tex':
             Image type: SG_IMAGETYPE_2D
             Sample type: SG_IMAGESAMPLETYPE_FLOAT
@@ -69,18 +105,29 @@
 #define ATTR_instance_aPos (0)
 #define ATTR_instance_aUV (1)
 #define ATTR_instance_aOffset (2)
-#define ATTR_instance_aUVOffset (3)
-#define ATTR_instance_aWorldScale (4)
-#define ATTR_instance_aUVScale (5)
-#define ATTR_instance_aRotation (6)
-#define ATTR_instance_aPivot (7)
-#define ATTR_instance_aTint (8)
-#define ATTR_text_position (0)
-#define ATTR_text_texcoord0 (1)
-#define ATTR_text_color0 (2)
+#define ATTR_instance_aScaleRot (3)
+#define ATTR_instance_aTint (4)
+#define ATTR_instance_indexed_aPos (0)
+#define ATTR_instance_indexed_aUV (1)
+#define ATTR_instance_indexed_aOffset (2)
+#define ATTR_instance_indexed_aScaleRot (3)
+#define ATTR_instance_indexed_aTint (4)
+#define ATTR_text_corner (0)
+#define ATTR_text_rect (1)
+#define ATTR_text_uv_rect (2)
+#define ATTR_text_color0 (3)
+#define ATTR_text_sdf_corner (0)
+#define ATTR_text_sdf_rect (1)
+#define ATTR_text_sdf_uv_rect (2)
+#define ATTR_text_sdf_color0 (3)
+#define ATTR_prim_position (0)
+#define ATTR_prim_color0 (1)
 #define UB_instance_params (0)
+#define UB_instance_frames (1)
 #define UB_text_params (0)
+#define UB_prim_params (0)
 #define VIEW_inst_tex (0)
+#define VIEW_inst_palette (1)
 #define VIEW_text_tex (1)
 #define SMP_inst_smp (0)
 #define SMP_text_smp (1)
@@ -90,88 +137,104 @@ SOKOL_SHDC_ALIGN(16) typedef struct instance_params_t {
 } instance_params_t;
 #pragma pack(pop)
 #pragma pack(push,1)
+SOKOL_SHDC_ALIGN(16) typedef struct instance_frames_t {
+    Asura::Math::Vec4 atlas_size;
+    Asura::Math::Vec4 frames[128];
+} instance_frames_t;
+#pragma pack(pop)
+#pragma pack(push,1)
 SOKOL_SHDC_ALIGN(16) typedef struct text_params_t {
     Asura::Math::Mat4 mvp;
 } text_params_t;
 #pragma pack(pop)
+#pragma pack(push,1)
+SOKOL_SHDC_ALIGN(16) typedef struct prim_params_t {
+    Asura::Math::Mat4 mvp;
+} prim_params_t;
+#pragma pack(pop)
 /*
     #version 410
 
     uniform vec4 instance_params[4];
-    layout(location = 6) in float aRotation;
+    uniform vec4 instance_frames[129];
+    layout(location = 3) in vec4 aScaleRot;
     layout(location = 0) in vec2 aPos;
-    layout(location = 7) in vec2 aPivot;
-    layout(location = 4) in vec2 aWorldScale;
     layout(location = 2) in vec2 aOffset;
     layout(location = 0) out vec2 vUV;
-    layout(location = 3) in vec2 aUVOffset;
     layout(location = 1) in vec2 aUV;
-    layout(location = 5) in vec2 aUVScale;
     layout(location = 1) out vec4 vTint;
-    layout(location = 8) in vec4 aTint;
+    layout(location = 4) in vec4 aTint;
+    layout(location = 2) out float vPalette;
 
     void main()
     {
-        float _12 = cos(aRotation);
-        float _15 = sin(aRotation);
-        gl_Position = mat4(instance_params[0], instance_params[1], instance_params[2], instance_params[3]) * vec4((mat2(vec2(_12, -_15), vec2(_15, _12)) * ((aPos - aPivot) * aWorldScale)) + aOffset, 0.0, 1.0);
-        vUV = aUVOffset + (aUV * aUVScale);
+        int _20 = int(aScaleRot.w);
+        vec4 _24 = instance_frames[(_20 % 128) + 1];
+        float _33 = cos(aScaleRot.z);
+        float _37 = sin(aScaleRot.z);
+        gl_Position = mat4(instance_params[0], instance_params[1], instance_params[2], instance_params[3]) * vec4((mat2(vec2(_33, -_37), vec2(_37, _33)) * (aPos * ((_24.zw * instance_frames[0].xy) * aScaleRot.xy))) + aOffset, 0.0, 1.0);
+        vUV = _24.xy + (aUV * _24.zw);
         vTint = aTint;
+        vPalette = float(_20 / 128);
     }
 
 */
-static const uint8_t vs_inst_source_glsl410[809] = {
+static const uint8_t vs_inst_source_glsl410[866] = {
     0x23,0x76,0x65,0x72,0x73,0x69,0x6f,0x6e,0x20,0x34,0x31,0x30,0x0a,0x0a,0x75,0x6e,
     0x69,0x66,0x6f,0x72,0x6d,0x20,0x76,0x65,0x63,0x34,0x20,0x69,0x6e,0x73,0x74,0x61,
-    0x6e,0x63,0x65,0x5f,0x70,0x61,0x72,0x61,0x6d,0x73,0x5b,0x34,0x5d,0x3b,0x0a,0x6c,
-    0x61,0x79,0x6f,0x75,0x74,0x28,0x6c,0x6f,0x63,0x61,0x74,0x69,0x6f,0x6e,0x20,0x3d,
-    0x20,0x36,0x29,0x20,0x69,0x6e,0x20,0x66,0x6c,0x6f,0x61,0x74,0x20,0x61,0x52,0x6f,
-    0x74,0x61,0x74,0x69,0x6f,0x6e,0x3b,0x0a,0x6c,0x61,0x79,0x6f,0x75,0x74,0x28,0x6c,
-    0x6f,0x63,0x61,0x74,0x69,0x6f,0x6e,0x20,0x3d,0x20,0x30,0x29,0x20,0x69,0x6e,0x20,
-    0x76,0x65,0x63,0x32,0x20,0x61,0x50,0x6f,0x73,0x3b,0x0a,0x6c,0x61,0x79,0x6f,0x75,
-    0x74,0x28,0x6c,0x6f,0x63,0x61,0x74,0x69,0x6f,0x6e,0x20,0x3d,0x20,0x37,0x29,0x20,
-    0x69,0x6e,0x20,0x76,0x65,0x63,0x32,0x20,0x61,0x50,0x69,0x76,0x6f,0x74,0x3b,0x0a,
-    0x6c,0x61,0x79,0x6f,0x75,0x74,0x28,0x6c,0x6f,0x63,0x61,0x74,0x69,0x6f,0x6e,0x20,
-    0x3d,0x20,0x34,0x29,0x20,0x69,0x6e,0x20,0x76,0x65,0x63,0x32,0x20,0x61,0x57,0x6f,
-    0x72,0x6c,0x64,0x53,0x63,0x61,0x6c,0x65,0x3b,0x0a,0x6c,0x61,0x79,0x6f,0x75,0x74,
-    0x28,0x6c,0x6f,0x63,0x61,0x74,0x69,0x6f,0x6e,0x20,0x3d,0x20,0x32,0x29,0x20,0x69,
-    0x6e,0x20,0x76,0x65,0x63,0x32,0x20,0x61,0x4f,0x66,0x66,0x73,0x65,0x74,0x3b,0x0a,
-    0x6c,0x61,0x79,0x6f,0x75,0x74,0x28,0x6c,0x6f,0x63,0x61,0x74,0x69,0x6f,0x6e,0x20,
-    0x3d,0x20,0x30,0x29,0x20,0x6f,0x75,0x74,0x20,0x76,0x65,0x63,0x32,0x20,0x76,0x55,
-    0x56,0x3b,0x0a,0x6c,0x61,0x79,0x6f,0x75,0x74,0x28,0x6c,0x6f,0x63,0x61,0x74,0x69,
-    0x6f,0x6e,0x20,0x3d,0x20,0x33,0x29,0x20,0x69,0x6e,0x20,0x76,0x65,0x63,0x32,0x20,
-    0x61,0x55,0x56,0x4f,0x66,0x66,0x73,0x65,0x74,0x3b,0x0a,0x6c,0x61,0x79,0x6f,0x75,
-    0x74,0x28,0x6c,0x6f,0x63,0x61,0x74,0x69,0x6f,0x6e,0x20,0x3d,0x20,0x31,0x29,0x20,
-    0x69,0x6e,0x20,0x76,0x65,0x63,0x32,0x20,0x61,0x55,0x56,0x3b,0x0a,0x6c,0x61,0x79,
-    0x6f,0x75,0x74,0x28,0x6c,0x6f,0x63,0x61,0x74,0x69,0x6f,0x6e,0x20,0x3d,0x20,0x35,
-    0x29,0x20,0x69,0x6e,0x20,0x76,0x65,0x63,0x32,0x20,0x61,0x55,0x56,0x53,0x63,0x61,
-    0x6c,0x65,0x3b,0x0a,0x6c,0x61,0x79,0x6f,0x75,0x74,0x28,0x6c,0x6f,0x63,0x61,0x74,
-    0x69,0x6f,0x6e,0x20,0x3d,0x20,0x31,0x29,0x20,0x6f,0x75,0x74,0x20,0x76,0x65,0x63,
-    0x34,0x20,0x76,0x54,0x69,0x6e,0x74,0x3b,0x0a,0x6c,0x61,0x79,0x6f,0x75,0x74,0x28,
-    0x6c,0x6f,0x63,0x61,0x74,0x69,0x6f,0x6e,0x20,0x3d,0x20,0x38,0x29,0x20,0x69,0x6e,
-    0x20,0x76,0x65,0x63,0x34,0x20,0x61,0x54,0x69,0x6e,0x74,0x3b,0x0a,0x0a,0x76,0x6f,
-    0x69,0x64,0x20,0x6d,0x61,0x69,0x6e,0x28,0x29,0x0a,0x7b,0x0a,0x20,0x20,0x20,0x20,
-    0x66,0x6c,0x6f,0x61,0x74,0x20,0x5f,0x31,0x32,0x20,0x3d,0x20,0x63,0x6f,0x73,0x28,
-    0x61,0x52,0x6f,0x74,0x61,0x74,0x69,0x6f,0x6e,0x29,0x3b,0x0a,0x20,0x20,0x20,0x20,
-    0x66,0x6c,0x6f,0x61,0x74,0x20,0x5f,0x31,0x35,0x20,0x3d,0x20,0x73,0x69,0x6e,0x28,
-    0x61,0x52,0x6f,0x74,0x61,0x74,0x69,0x6f,0x6e,0x29,0x3b,0x0a,0x20,0x20,0x20,0x20,
-    0x67,0x6c,0x5f,0x50,0x6f,0x73,0x69,0x74,0x69,0x6f,0x6e,0x20,0x3d,0x20,0x6d,0x61,
-    0x74,0x34,0x28,0x69,0x6e,0x73,0x74,0x61,0x6e,0x63,0x65,0x5f,0x70,0x61,0x72,0x61,
-    0x6d,0x73,0x5b,0x30,0x5d,0x2c,0x20,0x69,0x6e,0x73,0x74,0x61,0x6e,0x63,0x65,0x5f,
-    0x70,0x61,0x72,0x61,0x6d,0x73,0x5b,0x31,0x5d,0x2c,0x20,0x69,0x6e,0x73,0x74,0x61,
-    0x6e,0x63,0x65,0x5f,0x70,0x61,0x72,0x61,0x6d,0x73,0x5b,0x32,0x5d,0x2c,0x20,0x69,
-    0x6e,0x73,0x74,0x61,0x6e,0x63,0x65,0x5f,0x70,0x61,0x72,0x61,0x6d,0x73,0x5b,0x33,
-    0x5d,0x29,0x20,0x2a,0x20,0x76,0x65,0x63,0x34,0x28,0x28,0x6d,0x61,0x74,0x32,0x28,
-    0x76,0x65,0x63,0x32,0x28,0x5f,0x31,0x32,0x2c,0x20,0x2d,0x5f,0x31,0x35,0x29,0x2c,
-    0x20,0x76,0x65,0x63,0x32,0x28,0x5f,0x31,0x35,0x2c,0x20,0x5f,0x31,0x32,0x29,0x29,
-    0x20,0x2a,0x20,0x28,0x28,0x61,0x50,0x6f,0x73,0x20,0x2d,0x20,0x61,0x50,0x69,0x76,
-    0x6f,0x74,0x29,0x20,0x2a,0x20,0x61,0x57,0x6f,0x72,0x6c,0x64,0x53,0x63,0x61,0x6c,
-    0x65,0x29,0x29,0x20,0x2b,0x20,0x61,0x4f,0x66,0x66,0x73,0x65,0x74,0x2c,0x20,0x30,
-    0x2e,0x30,0x2c,0x20,0x31,0x2e,0x30,0x29,0x3b,0x0a,0x20,0x20,0x20,0x20,0x76,0x55,
-    0x56,0x20,0x3d,0x20,0x61,0x55,0x56,0x4f,0x66,0x66,0x73,0x65,0x74,0x20,0x2b,0x20,
-    0x28,0x61,0x55,0x56,0x20,0x2a,0x20,0x61,0x55,0x56,0x53,0x63,0x61,0x6c,0x65,0x29,
-    0x3b,0x0a,0x20,0x20,0x20,0x20,0x76,0x54,0x69,0x6e,0x74,0x20,0x3d,0x20,0x61,0x54,
-    0x69,0x6e,0x74,0x3b,0x0a,0x7d,0x0a,0x0a,0x00,
+    0x6e,0x63,0x65,0x5f,0x70,0x61,0x72,0x61,0x6d,0x73,0x5b,0x34,0x5d,0x3b,0x0a,0x75,
+    0x6e,0x69,0x66,0x6f,0x72,0x6d,0x20,0x76,0x65,0x63,0x34,0x20,0x69,0x6e,0x73,0x74,
+    0x61,0x6e,0x63,0x65,0x5f,0x66,0x72,0x61,0x6d,0x65,0x73,0x5b,0x31,0x32,0x39,0x5d,
+    0x3b,0x0a,0x6c,0x61,0x79,0x6f,0x75,0x74,0x28,0x6c,0x6f,0x63,0x61,0x74,0x69,0x6f,
+    0x6e,0x20,0x3d,0x20,0x33,0x29,0x20,0x69,0x6e,0x20,0x76,0x65,0x63,0x34,0x20,0x61,
+    0x53,0x63,0x61,0x6c,0x65,0x52,0x6f,0x74,0x3b,0x0a,0x6c,0x61,0x79,0x6f,0x75,0x74,
+    0x28,0x6c,0x6f,0x63,0x61,0x74,0x69,0x6f,0x6e,0x20,0x3d,0x20,0x30,0x29,0x20,0x69,
+    0x6e,0x20,0x76,0x65,0x63,0x32,0x20,0x61,0x50,0x6f,0x73,0x3b,0x0a,0x6c,0x61,0x79,
+    0x6f,0x75,0x74,0x28,0x6c,0x6f,0x63,0x61,0x74,0x69,0x6f,0x6e,0x20,0x3d,0x20,0x32,
+    0x29,0x20,0x69,0x6e,0x20,0x76,0x65,0x63,0x32,0x20,0x61,0x4f,0x66,0x66,0x73,0x65,
+    0x74,0x3b,0x0a,0x6c,0x61,0x79,0x6f,0x75,0x74,0x28,0x6c,0x6f,0x63,0x61,0x74,0x69,
+    0x6f,0x6e,0x20,0x3d,0x20,0x30,0x29,0x20,0x6f,0x75,0x74,0x20,0x76,0x65,0x63,0x32,
+    0x20,0x76,0x55,0x56,0x3b,0x0a,0x6c,0x61,0x79,0x6f,0x75,0x74,0x28,0x6c,0x6f,0x63,
+    0x61,0x74,0x69,0x6f,0x6e,0x20,0x3d,0x20,0x31,0x29,0x20,0x69,0x6e,0x20,0x76,0x65,
+    0x63,0x32,0x20,0x61,0x55,0x56,0x3b,0x0a,0x6c,0x61,0x79,0x6f,0x75,0x74,0x28,0x6c,
+    0x6f,0x63,0x61,0x74,0x69,0x6f,0x6e,0x20,0x3d,0x20,0x31,0x29,0x20,0x6f,0x75,0x74,
+    0x20,0x76,0x65,0x63,0x34,0x20,0x76,0x54,0x69,0x6e,0x74,0x3b,0x0a,0x6c,0x61,0x79,
+    0x6f,0x75,0x74,0x28,0x6c,0x6f,0x63,0x61,0x74,0x69,0x6f,0x6e,0x20,0x3d,0x20,0x34,
+    0x29,0x20,0x69,0x6e,0x20,0x76,0x65,0x63,0x34,0x20,0x61,0x54,0x69,0x6e,0x74,0x3b,
+    0x0a,0x6c,0x61,0x79,0x6f,0x75,0x74,0x28,0x6c,0x6f,0x63,0x61,0x74,0x69,0x6f,0x6e,
+    0x20,0x3d,0x20,0x32,0x29,0x20,0x6f,0x75,0x74,0x20,0x66,0x6c,0x6f,0x61,0x74,0x20,
+    0x76,0x50,0x61,0x6c,0x65,0x74,0x74,0x65,0x3b,0x0a,0x0a,0x76,0x6f,0x69,0x64,0x20,
+    0x6d,0x61,0x69,0x6e,0x28,0x29,0x0a,0x7b,0x0a,0x20,0x20,0x20,0x20,0x69,0x6e,0x74,
+    0x20,0x5f,0x32,0x30,0x20,0x3d,0x20,0x69,0x6e,0x74,0x28,0x61,0x53,0x63,0x61,0x6c,
+    0x65,0x52,0x6f,0x74,0x2e,0x77,0x29,0x3b,0x0a,0x20,0x20,0x20,0x20,0x76,0x65,0x63,
+    0x34,0x20,0x5f,0x32,0x34,0x20,0x3d,0x20,0x69,0x6e,0x73,0x74,0x61,0x6e,0x63,0x65,
+    0x5f,0x66,0x72,0x61,0x6d,0x65,0x73,0x5b,0x28,0x5f,0x32,0x30,0x20,0x25,0x20,0x31,
+    0x32,0x38,0x29,0x20,0x2b,0x20,0x31,0x5d,0x3b,0x0a,0x20,0x20,0x20,0x20,0x66,0x6c,
+    0x6f,0x61,0x74,0x20,0x5f,0x33,0x33,0x20,0x3d,0x20,0x63,0x6f,0x73,0x28,0x61,0x53,
+    0x63,0x61,0x6c,0x65,0x52,0x6f,0x74,0x2e,0x7a,0x29,0x3b,0x0a,0x20,0x20,0x20,0x20,
+    0x66,0x6c,0x6f,0x61,0x74,0x20,0x5f,0x33,0x37,0x20,0x3d,0x20,0x73,0x69,0x6e,0x28,
+    0x61,0x53,0x63,0x61,0x6c,0x65,0x52,0x6f,0x74,0x2e,0x7a,0x29,0x3b,0x0a,0x20,0x20,
+    0x20,0x20,0x67,0x6c,0x5f,0x50,0x6f,0x73,0x69,0x74,0x69,0x6f,0x6e,0x20,0x3d,0x20,
+    0x6d,0x61,0x74,0x34,0x28,0x69,0x6e,0x73,0x74,0x61,0x6e,0x63,0x65,0x5f,0x70,0x61,
+    0x72,0x61,0x6d,0x73,0x5b,0x30,0x5d,0x2c,0x20,0x69,0x6e,0x73,0x74,0x61,0x6e,0x63,
+    0x65,0x5f,0x70,0x61,0x72,0x61,0x6d,0x73,0x5b,0x31,0x5d,0x2c,0x20,0x69,0x6e,0x73,
+    0x74,0x61,0x6e,0x63,0x65,0x5f,0x70,0x61,0x72,0x61,0x6d,0x73,0x5b,0x32,0x5d,0x2c,
+    0x20,0x69,0x6e,0x73,0x74,0x61,0x6e,0x63,0x65,0x5f,0x70,0x61,0x72,0x61,0x6d,0x73,
+    0x5b,0x33,0x5d,0x29,0x20,0x2a,0x20,0x76,0x65,0x63,0x34,0x28,0x28,0x6d,0x61,0x74,
+    0x32,0x28,0x76,0x65,0x63,0x32,0x28,0x5f,0x33,0x33,0x2c,0x20,0x2d,0x5f,0x33,0x37,
+    0x29,0x2c,0x20,0x76,0x65,0x63,0x32,0x28,0x5f,0x33,0x37,0x2c,0x20,0x5f,0x33,0x33,
+    0x29,0x29,0x20,0x2a,0x20,0x28,0x61,0x50,0x6f,0x73,0x20,0x2a,0x20,0x28,0x28,0x5f,
+    0x32,0x34,0x2e,0x7a,0x77,0x20,0x2a,0x20,0x69,0x6e,0x73,0x74,0x61,0x6e,0x63,0x65,
+    0x5f,0x66,0x72,0x61,0x6d,0x65,0x73,0x5b,0x30,0x5d,0x2e,0x78,0x79,0x29,0x20,0x2a,
+    0x20,0x61,0x53,0x63,0x61,0x6c,0x65,0x52,0x6f,0x74,0x2e,0x78,0x79,0x29,0x29,0x29,
+    0x20,0x2b,0x20,0x61,0x4f,0x66,0x66,0x73,0x65,0x74,0x2c,0x20,0x30,0x2e,0x30,0x2c,
+    0x20,0x31,0x2e,0x30,0x29,0x3b,0x0a,0x20,0x20,0x20,0x20,0x76,0x55,0x56,0x20,0x3d,
+    0x20,0x5f,0x32,0x34,0x2e,0x78,0x79,0x20,0x2b,0x20,0x28,0x61,0x55,0x56,0x20,0x2a,
+    0x20,0x5f,0x32,0x34,0x2e,0x7a,0x77,0x29,0x3b,0x0a,0x20,0x20,0x20,0x20,0x76,0x54,
+    0x69,0x6e,0x74,0x20,0x3d,0x20,0x61,0x54,0x69,0x6e,0x74,0x3b,0x0a,0x20,0x20,0x20,
+    0x20,0x76,0x50,0x61,0x6c,0x65,0x74,0x74,0x65,0x20,0x3d,0x20,0x66,0x6c,0x6f,0x61,
+    0x74,0x28,0x5f,0x32,0x30,0x20,0x2f,0x20,0x31,0x32,0x38,0x29,0x3b,0x0a,0x7d,0x0a,
+    0x0a,0x00,
 };
 /*
     #version 410
@@ -181,6 +244,7 @@ static const uint8_t vs_inst_source_glsl410[809] = {
     layout(location = 0) out vec4 FragColor;
     layout(location = 1) in vec4 vTint;
     layout(location = 0) in vec2 vUV;
+    layout(location = 2) in float vPalette;
 
     void main()
     {
@@ -188,7 +252,7 @@ static const uint8_t vs_inst_source_glsl410[809] = {
     }
 
 */
-static const uint8_t fs_inst_source_glsl410[239] = {
+static const uint8_t fs_inst_source_glsl410[279] = {
     0x23,0x76,0x65,0x72,0x73,0x69,0x6f,0x6e,0x20,0x34,0x31,0x30,0x0a,0x0a,0x75,0x6e,
     0x69,0x66,0x6f,0x72,0x6d,0x20,0x73,0x61,0x6d,0x70,0x6c,0x65,0x72,0x32,0x44,0x20,
     0x69,0x6e,0x73,0x74,0x5f,0x74,0x65,0x78,0x5f,0x69,0x6e,0x73,0x74,0x5f,0x73,0x6d,
@@ -199,57 +263,111 @@ static const uint8_t fs_inst_source_glsl410[239] = {
     0x29,0x20,0x69,0x6e,0x20,0x76,0x65,0x63,0x34,0x20,0x76,0x54,0x69,0x6e,0x74,0x3b,
     0x0a,0x6c,0x61,0x79,0x6f,0x75,0x74,0x28,0x6c,0x6f,0x63,0x61,0x74,0x69,0x6f,0x6e,
     0x20,0x3d,0x20,0x30,0x29,0x20,0x69,0x6e,0x20,0x76,0x65,0x63,0x32,0x20,0x76,0x55,
-    0x56,0x3b,0x0a,0x0a,0x76,0x6f,0x69,0x64,0x20,0x6d,0x61,0x69,0x6e,0x28,0x29,0x0a,
-    0x7b,0x0a,0x20,0x20,0x20,0x20,0x46,0x72,0x61,0x67,0x43,0x6f,0x6c,0x6f,0x72,0x20,
-    0x3d,0x20,0x76,0x54,0x69,0x6e,0x74,0x20,0x2a,0x20,0x74,0x65,0x78,0x74,0x75,0x72,
-    0x65,0x28,0x69,0x6e,0x73,0x74,0x5f,0x74,0x65,0x78,0x5f,0x69,0x6e,0x73,0x74,0x5f,
-    0x73,0x6d,0x70,0x2c,0x20,0x76,0x55,0x56,0x29,0x3b,0x0a,0x7d,0x0a,0x0a,0x00,
+    0x56,0x3b,0x0a,0x6c,0x61,0x79,0x6f,0x75,0x74,0x28,0x6c,0x6f,0x63,0x61,0x74,0x69,
+    0x6f,0x6e,0x20,0x3d,0x20,0x32,0x29,0x20,0x69,0x6e,0x20,0x66,0x6c,0x6f,0x61,0x74,
+    0x20,0x76,0x50,0x61,0x6c,0x65,0x74,0x74,0x65,0x3b,0x0a,0x0a,0x76,0x6f,0x69,0x64,
+    0x20,0x6d,0x61,0x69,0x6e,0x28,0x29,0x0a,0x7b,0x0a,0x20,0x20,0x20,0x20,0x46,0x72,
+    0x61,0x67,0x43,0x6f,0x6c,0x6f,0x72,0x20,0x3d,0x20,0x76,0x54,0x69,0x6e,0x74,0x20,
+    0x2a,0x20,0x74,0x65,0x78,0x74,0x75,0x72,0x65,0x28,0x69,0x6e,0x73,0x74,0x5f,0x74,
+    0x65,0x78,0x5f,0x69,0x6e,0x73,0x74,0x5f,0x73,0x6d,0x70,0x2c,0x20,0x76,0x55,0x56,
+    0x29,0x3b,0x0a,0x7d,0x0a,0x0a,0x00,
+};
+/*
+    #version 410
+
+    uniform sampler2D inst_tex_inst_smp;
+    uniform sampler2D inst_palette_inst_smp;
+
+    layout(location = 0) in vec2 vUV;
+    layout(location = 2) in float vPalette;
+    layout(location = 0) out vec4 FragColor;
+    layout(location = 1) in vec4 vTint;
+
+    void main()
+    {
+        FragColor = vTint * texelFetch(inst_palette_inst_smp, ivec2(int((texture(inst_tex_inst_smp, vUV).x * 255.0) + 0.5), int(vPalette + 0.5)), 0);
+    }
+
+*/
+static const uint8_t fs_inst_indexed_source_glsl410[409] = {
+    0x23,0x76,0x65,0x72,0x73,0x69,0x6f,0x6e,0x20,0x34,0x31,0x30,0x0a,0x0a,0x75,0x6e,
+    0x69,0x66,0x6f,0x72,0x6d,0x20,0x73,0x61,0x6d,0x70,0x6c,0x65,0x72,0x32,0x44,0x20,
+    0x69,0x6e,0x73,0x74,0x5f,0x74,0x65,0x78,0x5f,0x69,0x6e,0x73,0x74,0x5f,0x73,0x6d,
+    0x70,0x3b,0x0a,0x75,0x6e,0x69,0x66,0x6f,0x72,0x6d,0x20,0x73,0x61,0x6d,0x70,0x6c,
+    0x65,0x72,0x32,0x44,0x20,0x69,0x6e,0x73,0x74,0x5f,0x70,0x61,0x6c,0x65,0x74,0x74,
+    0x65,0x5f,0x69,0x6e,0x73,0x74,0x5f,0x73,0x6d,0x70,0x3b,0x0a,0x0a,0x6c,0x61,0x79,
+    0x6f,0x75,0x74,0x28,0x6c,0x6f,0x63,0x61,0x74,0x69,0x6f,0x6e,0x20,0x3d,0x20,0x30,
+    0x29,0x20,0x69,0x6e,0x20,0x76,0x65,0x63,0x32,0x20,0x76,0x55,0x56,0x3b,0x0a,0x6c,
+    0x61,0x79,0x6f,0x75,0x74,0x28,0x6c,0x6f,0x63,0x61,0x74,0x69,0x6f,0x6e,0x20,0x3d,
+    0x20,0x32,0x29,0x20,0x69,0x6e,0x20,0x66,0x6c,0x6f,0x61,0x74,0x20,0x76,0x50,0x61,
+    0x6c,0x65,0x74,0x74,0x65,0x3b,0x0a,0x6c,0x61,0x79,0x6f,0x75,0x74,0x28,0x6c,0x6f,
+    0x63,0x61,0x74,0x69,0x6f,0x6e,0x20,0x3d,0x20,0x30,0x29,0x20,0x6f,0x75,0x74,0x20,
+    0x76,0x65,0x63,0x34,0x20,0x46,0x72,0x61,0x67,0x43,0x6f,0x6c,0x6f,0x72,0x3b,0x0a,
+    0x6c,0x61,0x79,0x6f,0x75,0x74,0x28,0x6c,0x6f,0x63,0x61,0x74,0x69,0x6f,0x6e,0x20,
+    0x3d,0x20,0x31,0x29,0x20,0x69,0x6e,0x20,0x76,0x65,0x63,0x34,0x20,0x76,0x54,0x69,
+    0x6e,0x74,0x3b,0x0a,0x0a,0x76,0x6f,0x69,0x64,0x20,0x6d,0x61,0x69,0x6e,0x28,0x29,
+    0x0a,0x7b,0x0a,0x20,0x20,0x20,0x20,0x46,0x72,0x61,0x67,0x43,0x6f,0x6c,0x6f,0x72,
+    0x20,0x3d,0x20,0x76,0x54,0x69,0x6e,0x74,0x20,0x2a,0x20,0x74,0x65,0x78,0x65,0x6c,
+    0x46,0x65,0x74,0x63,0x68,0x28,0x69,0x6e,0x73,0x74,0x5f,0x70,0x61,0x6c,0x65,0x74,
+    0x74,0x65,0x5f,0x69,0x6e,0x73,0x74,0x5f,0x73,0x6d,0x70,0x2c,0x20,0x69,0x76,0x65,
+    0x63,0x32,0x28,0x69,0x6e,0x74,0x28,0x28,0x74,0x65,0x78,0x74,0x75,0x72,0x65,0x28,
+    0x69,0x6e,0x73,0x74,0x5f,0x74,0x65,0x78,0x5f,0x69,0x6e,0x73,0x74,0x5f,0x73,0x6d,
+    0x70,0x2c,0x20,0x76,0x55,0x56,0x29,0x2e,0x78,0x20,0x2a,0x20,0x32,0x35,0x35,0x2e,
+    0x30,0x29,0x20,0x2b,0x20,0x30,0x2e,0x35,0x29,0x2c,0x20,0x69,0x6e,0x74,0x28,0x76,
+    0x50,0x61,0x6c,0x65,0x74,0x74,0x65,0x20,0x2b,0x20,0x30,0x2e,0x35,0x29,0x29,0x2c,
+    0x20,0x30,0x29,0x3b,0x0a,0x7d,0x0a,0x0a,0x00,
 };
 /*
     #version 410
 
     uniform vec4 text_params[4];
-    layout(location = 0) in vec2 position;
+    layout(location = 1) in vec4 rect;
+    layout(location = 0) in vec2 corner;
     layout(location = 0) out vec2 uv;
-    layout(location = 1) in vec2 texcoord0;
+    layout(location = 2) in vec4 uv_rect;
     layout(location = 1) out vec4 color;
-    layout(location = 2) in vec4 color0;
+    layout(location = 3) in vec4 color0;
 
     void main()
     {
-        gl_Position = mat4(text_params[0], text_params[1], text_params[2], text_params[3]) * vec4(position, 0.0, 1.0);
-        uv = texcoord0;
+        gl_Position = mat4(text_params[0], text_params[1], text_params[2], text_params[3]) * vec4(rect.xy + (corner * rect.zw), 0.0, 1.0);
+        uv = mix(uv_rect.xy, uv_rect.zw, corner);
         color = color0;
     }
 
 */
-static const uint8_t vs_text_source_glsl410[404] = {
+static const uint8_t vs_text_source_glsl410[481] = {
     0x23,0x76,0x65,0x72,0x73,0x69,0x6f,0x6e,0x20,0x34,0x31,0x30,0x0a,0x0a,0x75,0x6e,
     0x69,0x66,0x6f,0x72,0x6d,0x20,0x76,0x65,0x63,0x34,0x20,0x74,0x65,0x78,0x74,0x5f,
     0x70,0x61,0x72,0x61,0x6d,0x73,0x5b,0x34,0x5d,0x3b,0x0a,0x6c,0x61,0x79,0x6f,0x75,
-    0x74,0x28,0x6c,0x6f,0x63,0x61,0x74,0x69,0x6f,0x6e,0x20,0x3d,0x20,0x30,0x29,0x20,
-    0x69,0x6e,0x20,0x76,0x65,0x63,0x32,0x20,0x70,0x6f,0x73,0x69,0x74,0x69,0x6f,0x6e,
-    0x3b,0x0a,0x6c,0x61,0x79,0x6f,0x75,0x74,0x28,0x6c,0x6f,0x63,0x61,0x74,0x69,0x6f,
-    0x6e,0x20,0x3d,0x20,0x30,0x29,0x20,0x6f,0x75,0x74,0x20,0x76,0x65,0x63,0x32,0x20,
-    0x75,0x76,0x3b,0x0a,0x6c,0x61,0x79,0x6f,0x75,0x74,0x28,0x6c,0x6f,0x63,0x61,0x74,
-    0x69,0x6f,0x6e,0x20,0x3d,0x20,0x31,0x29,0x20,0x69,0x6e,0x20,0x76,0x65,0x63,0x32,
-    0x20,0x74,0x65,0x78,0x63,0x6f,0x6f,0x72,0x64,0x30,0x3b,0x0a,0x6c,0x61,0x79,0x6f,
-    0x75,0x74,0x28,0x6c,0x6f,0x63,0x61,0x74,0x69,0x6f,0x6e,0x20,0x3d,0x20,0x31,0x29,
-    0x20,0x6f,0x75,0x74,0x20,0x76,0x65,0x63,0x34,0x20,0x63,0x6f,0x6c,0x6f,0x72,0x3b,
-    0x0a,0x6c,0x61,0x79,0x6f,0x75,0x74,0x28,0x6c,0x6f,0x63,0x61,0x74,0x69,0x6f,0x6e,
-    0x20,0x3d,0x20,0x32,0x29,0x20,0x69,0x6e,0x20,0x76,0x65,0x63,0x34,0x20,0x63,0x6f,
-    0x6c,0x6f,0x72,0x30,0x3b,0x0a,0x0a,0x76,0x6f,0x69,0x64,0x20,0x6d,0x61,0x69,0x6e,
-    0x28,0x29,0x0a,0x7b,0x0a,0x20,0x20,0x20,0x20,0x67,0x6c,0x5f,0x50,0x6f,0x73,0x69,
-    0x74,0x69,0x6f,0x6e,0x20,0x3d,0x20,0x6d,0x61,0x74,0x34,0x28,0x74,0x65,0x78,0x74,
-    0x5f,0x70,0x61,0x72,0x61,0x6d,0x73,0x5b,0x30,0x5d,0x2c,0x20,0x74,0x65,0x78,0x74,
-    0x5f,0x70,0x61,0x72,0x61,0x6d,0x73,0x5b,0x31,0x5d,0x2c,0x20,0x74,0x65,0x78,0x74,
-    0x5f,0x70,0x61,0x72,0x61,0x6d,0x73,0x5b,0x32,0x5d,0x2c,0x20,0x74,0x65,0x78,0x74,
-    0x5f,0x70,0x61,0x72,0x61,0x6d,0x73,0x5b,0x33,0x5d,0x29,0x20,0x2a,0x20,0x76,0x65,
-    0x63,0x34,0x28,0x70,0x6f,0x73,0x69,0x74,0x69,0x6f,0x6e,0x2c,0x20,0x30,0x2e,0x30,
-    0x2c,0x20,0x31,0x2e,0x30,0x29,0x3b,0x0a,0x20,0x20,0x20,0x20,0x75,0x76,0x20,0x3d,
-    0x20,0x74,0x65,0x78,0x63,0x6f,0x6f,0x72,0x64,0x30,0x3b,0x0a,0x20,0x20,0x20,0x20,
-    0x63,0x6f,0x6c,0x6f,0x72,0x20,0x3d,0x20,0x63,0x6f,0x6c,0x6f,0x72,0x30,0x3b,0x0a,
-    0x7d,0x0a,0x0a,0x00,
+    0x74,0x28,0x6c,0x6f,0x63,0x61,0x74,0x69,0x6f,0x6e,0x20,0x3d,0x20,0x31,0x29,0x20,
+    0x69,0x6e,0x20,0x76,0x65,0x63,0x34,0x20,0x72,0x65,0x63,0x74,0x3b,0x0a,0x6c,0x61,
+    0x79,0x6f,0x75,0x74,0x28,0x6c,0x6f,0x63,0x61,0x74,0x69,0x6f,0x6e,0x20,0x3d,0x20,
+    0x30,0x29,0x20,0x69,0x6e,0x20,0x76,0x65,0x63,0x32,0x20,0x63,0x6f,0x72,0x6e,0x65,
+    0x72,0x3b,0x0a,0x6c,0x61,0x79,0x6f,0x75,0x74,0x28,0x6c,0x6f,0x63,0x61,0x74,0x69,
+    0x6f,0x6e,0x20,0x3d,0x20,0x30,0x29,0x20,0x6f,0x75,0x74,0x20,0x76,0x65,0x63,0x32,
+    0x20,0x75,0x76,0x3b,0x0a,0x6c,0x61,0x79,0x6f,0x75,0x74,0x28,0x6c,0x6f,0x63,0x61,
+    0x74,0x69,0x6f,0x6e,0x20,0x3d,0x20,0x32,0x29,0x20,0x69,0x6e,0x20,0x76,0x65,0x63,
+    0x34,0x20,0x75,0x76,0x5f,0x72,0x65,0x63,0x74,0x3b,0x0a,0x6c,0x61,0x79,0x6f,0x75,
+    0x74,0x28,0x6c,0x6f,0x63,0x61,0x74,0x69,0x6f,0x6e,0x20,0x3d,0x20,0x31,0x29,0x20,
+    0x6f,0x75,0x74,0x20,0x76,0x65,0x63,0x34,0x20,0x63,0x6f,0x6c,0x6f,0x72,0x3b,0x0a,
+    0x6c,0x61,0x79,0x6f,0x75,0x74,0x28,0x6c,0x6f,0x63,0x61,0x74,0x69,0x6f,0x6e,0x20,
+    0x3d,0x20,0x33,0x29,0x20,0x69,0x6e,0x20,0x76,0x65,0x63,0x34,0x20,0x63,0x6f,0x6c,
+    0x6f,0x72,0x30,0x3b,0x0a,0x0a,0x76,0x6f,0x69,0x64,0x20,0x6d,0x61,0x69,0x6e,0x28,
+    0x29,0x0a,0x7b,0x0a,0x20,0x20,0x20,0x20,0x67,0x6c,0x5f,0x50,0x6f,0x73,0x69,0x74,
+    0x69,0x6f,0x6e,0x20,0x3d,0x20,0x6d,0x61,0x74,0x34,0x28,0x74,0x65,0x78,0x74,0x5f,
+    0x70,0x61,0x72,0x61,0x6d,0x73,0x5b,0x30,0x5d,0x2c,0x20,0x74,0x65,0x78,0x74,0x5f,
+    0x70,0x61,0x72,0x61,0x6d,0x73,0x5b,0x31,0x5d,0x2c,0x20,0x74,0x65,0x78,0x74,0x5f,
+    0x70,0x61,0x72,0x61,0x6d,0x73,0x5b,0x32,0x5d,0x2c,0x20,0x74,0x65,0x78,0x74,0x5f,
+    0x70,0x61,0x72,0x61,0x6d,0x73,0x5b,0x33,0x5d,0x29,0x20,0x2a,0x20,0x76,0x65,0x63,
+    0x34,0x28,0x72,0x65,0x63,0x74,0x2e,0x78,0x79,0x20,0x2b,0x20,0x28,0x63,0x6f,0x72,
+    0x6e,0x65,0x72,0x20,0x2a,0x20,0x72,0x65,0x63,0x74,0x2e,0x7a,0x77,0x29,0x2c,0x20,
+    0x30,0x2e,0x30,0x2c,0x20,0x31,0x2e,0x30,0x29,0x3b,0x0a,0x20,0x20,0x20,0x20,0x75,
+    0x76,0x20,0x3d,0x20,0x6d,0x69,0x78,0x28,0x75,0x76,0x5f,0x72,0x65,0x63,0x74,0x2e,
+    0x78,0x79,0x2c,0x20,0x75,0x76,0x5f,0x72,0x65,0x63,0x74,0x2e,0x7a,0x77,0x2c,0x20,
+    0x63,0x6f,0x72,0x6e,0x65,0x72,0x29,0x3b,0x0a,0x20,0x20,0x20,0x20,0x63,0x6f,0x6c,
+    0x6f,0x72,0x20,0x3d,0x20,0x63,0x6f,0x6c,0x6f,0x72,0x30,0x3b,0x0a,0x7d,0x0a,0x0a,
+    0x00,
 };
 /*
     #version 410
@@ -286,742 +404,108 @@ static const uint8_t fs_text_source_glsl410[260] = {
     0x7d,0x0a,0x0a,0x00,
 };
 /*
-    cbuffer instance_params : register(b0)
-    {
-        row_major float4x4 _64_mvp : packoffset(c0);
-    };
-
-
-    static float4 gl_Position;
-    static float aRotation;
-    static float2 aPos;
-    static float2 aPivot;
-    static float2 aWorldScale;
-    static float2 aOffset;
-    static float2 vUV;
-    static float2 aUVOffset;
-    static float2 aUV;
-    static float2 aUVScale;
-    static float4 vTint;
-    static float4 aTint;
-
-    struct SPIRV_Cross_Input
-    {
-        float2 aPos : TEXCOORD0;
-        float2 aUV : TEXCOORD1;
-        float2 aOffset : TEXCOORD2;
-        float2 aUVOffset : TEXCOORD3;
-        float2 aWorldScale : TEXCOORD4;
-        float2 aUVScale : TEXCOORD5;
-        float aRotation : TEXCOORD6;
-        float2 aPivot : TEXCOORD7;
-        float4 aTint : TEXCOORD8;
-    };
-
-    struct SPIRV_Cross_Output
-    {
-        float2 vUV : TEXCOORD0;
-        float4 vTint : TEXCOORD1;
-        float4 gl_Position : SV_Position;
-    };
-
-    void vert_main()
-    {
-        float _12 = cos(aRotation);
-        float _15 = sin(aRotation);
-        gl_Position = mul(float4(mul((aPos - aPivot) * aWorldScale, float2x2(float2(_12, -_15), float2(_15, _12))) + aOffset, 0.0f, 1.0f), _64_mvp);
-        vUV = aUVOffset + (aUV * aUVScale);
-        vTint = aTint;
-    }
-
-    SPIRV_Cross_Output main(SPIRV_Cross_Input stage_input)
-    {
-        aRotation = stage_input.aRotation;
-        aPos = stage_input.aPos;
-        aPivot = stage_input.aPivot;
-        aWorldScale = stage_input.aWorldScale;
-        aOffset = stage_input.aOffset;
-        aUVOffset = stage_input.aUVOffset;
-        aUV = stage_input.aUV;
-        aUVScale = stage_input.aUVScale;
-        aTint = stage_input.aTint;
-        vert_main();
-        SPIRV_Cross_Output stage_output;
-        stage_output.gl_Position = gl_Position;
-        stage_output.vUV = vUV;
-        stage_output.vTint = vTint;
-        return stage_output;
-    }
-*/
-static const uint8_t vs_inst_source_hlsl5[1659] = {
-    0x63,0x62,0x75,0x66,0x66,0x65,0x72,0x20,0x69,0x6e,0x73,0x74,0x61,0x6e,0x63,0x65,
-    0x5f,0x70,0x61,0x72,0x61,0x6d,0x73,0x20,0x3a,0x20,0x72,0x65,0x67,0x69,0x73,0x74,
-    0x65,0x72,0x28,0x62,0x30,0x29,0x0a,0x7b,0x0a,0x20,0x20,0x20,0x20,0x72,0x6f,0x77,
-    0x5f,0x6d,0x61,0x6a,0x6f,0x72,0x20,0x66,0x6c,0x6f,0x61,0x74,0x34,0x78,0x34,0x20,
-    0x5f,0x36,0x34,0x5f,0x6d,0x76,0x70,0x20,0x3a,0x20,0x70,0x61,0x63,0x6b,0x6f,0x66,
-    0x66,0x73,0x65,0x74,0x28,0x63,0x30,0x29,0x3b,0x0a,0x7d,0x3b,0x0a,0x0a,0x0a,0x73,
-    0x74,0x61,0x74,0x69,0x63,0x20,0x66,0x6c,0x6f,0x61,0x74,0x34,0x20,0x67,0x6c,0x5f,
-    0x50,0x6f,0x73,0x69,0x74,0x69,0x6f,0x6e,0x3b,0x0a,0x73,0x74,0x61,0x74,0x69,0x63,
-    0x20,0x66,0x6c,0x6f,0x61,0x74,0x20,0x61,0x52,0x6f,0x74,0x61,0x74,0x69,0x6f,0x6e,
-    0x3b,0x0a,0x73,0x74,0x61,0x74,0x69,0x63,0x20,0x66,0x6c,0x6f,0x61,0x74,0x32,0x20,
-    0x61,0x50,0x6f,0x73,0x3b,0x0a,0x73,0x74,0x61,0x74,0x69,0x63,0x20,0x66,0x6c,0x6f,
-    0x61,0x74,0x32,0x20,0x61,0x50,0x69,0x76,0x6f,0x74,0x3b,0x0a,0x73,0x74,0x61,0x74,
-    0x69,0x63,0x20,0x66,0x6c,0x6f,0x61,0x74,0x32,0x20,0x61,0x57,0x6f,0x72,0x6c,0x64,
-    0x53,0x63,0x61,0x6c,0x65,0x3b,0x0a,0x73,0x74,0x61,0x74,0x69,0x63,0x20,0x66,0x6c,
-    0x6f,0x61,0x74,0x32,0x20,0x61,0x4f,0x66,0x66,0x73,0x65,0x74,0x3b,0x0a,0x73,0x74,
-    0x61,0x74,0x69,0x63,0x20,0x66,0x6c,0x6f,0x61,0x74,0x32,0x20,0x76,0x55,0x56,0x3b,
-    0x0a,0x73,0x74,0x61,0x74,0x69,0x63,0x20,0x66,0x6c,0x6f,0x61,0x74,0x32,0x20,0x61,
-    0x55,0x56,0x4f,0x66,0x66,0x73,0x65,0x74,0x3b,0x0a,0x73,0x74,0x61,0x74,0x69,0x63,
-    0x20,0x66,0x6c,0x6f,0x61,0x74,0x32,0x20,0x61,0x55,0x56,0x3b,0x0a,0x73,0x74,0x61,
-    0x74,0x69,0x63,0x20,0x66,0x6c,0x6f,0x61,0x74,0x32,0x20,0x61,0x55,0x56,0x53,0x63,
-    0x61,0x6c,0x65,0x3b,0x0a,0x73,0x74,0x61,0x74,0x69,0x63,0x20,0x66,0x6c,0x6f,0x61,
-    0x74,0x34,0x20,0x76,0x54,0x69,0x6e,0x74,0x3b,0x0a,0x73,0x74,0x61,0x74,0x69,0x63,
-    0x20,0x66,0x6c,0x6f,0x61,0x74,0x34,0x20,0x61,0x54,0x69,0x6e,0x74,0x3b,0x0a,0x0a,
-    0x73,0x74,0x72,0x75,0x63,0x74,0x20,0x53,0x50,0x49,0x52,0x56,0x5f,0x43,0x72,0x6f,
-    0x73,0x73,0x5f,0x49,0x6e,0x70,0x75,0x74,0x0a,0x7b,0x0a,0x20,0x20,0x20,0x20,0x66,
-    0x6c,0x6f,0x61,0x74,0x32,0x20,0x61,0x50,0x6f,0x73,0x20,0x3a,0x20,0x54,0x45,0x58,
-    0x43,0x4f,0x4f,0x52,0x44,0x30,0x3b,0x0a,0x20,0x20,0x20,0x20,0x66,0x6c,0x6f,0x61,
-    0x74,0x32,0x20,0x61,0x55,0x56,0x20,0x3a,0x20,0x54,0x45,0x58,0x43,0x4f,0x4f,0x52,
-    0x44,0x31,0x3b,0x0a,0x20,0x20,0x20,0x20,0x66,0x6c,0x6f,0x61,0x74,0x32,0x20,0x61,
-    0x4f,0x66,0x66,0x73,0x65,0x74,0x20,0x3a,0x20,0x54,0x45,0x58,0x43,0x4f,0x4f,0x52,
-    0x44,0x32,0x3b,0x0a,0x20,0x20,0x20,0x20,0x66,0x6c,0x6f,0x61,0x74,0x32,0x20,0x61,
-    0x55,0x56,0x4f,0x66,0x66,0x73,0x65,0x74,0x20,0x3a,0x20,0x54,0x45,0x58,0x43,0x4f,
-    0x4f,0x52,0x44,0x33,0x3b,0x0a,0x20,0x20,0x20,0x20,0x66,0x6c,0x6f,0x61,0x74,0x32,
-    0x20,0x61,0x57,0x6f,0x72,0x6c,0x64,0x53,0x63,0x61,0x6c,0x65,0x20,0x3a,0x20,0x54,
-    0x45,0x58,0x43,0x4f,0x4f,0x52,0x44,0x34,0x3b,0x0a,0x20,0x20,0x20,0x20,0x66,0x6c,
-    0x6f,0x61,0x74,0x32,0x20,0x61,0x55,0x56,0x53,0x63,0x61,0x6c,0x65,0x20,0x3a,0x20,
-    0x54,0x45,0x58,0x43,0x4f,0x4f,0x52,0x44,0x35,0x3b,0x0a,0x20,0x20,0x20,0x20,0x66,
-    0x6c,0x6f,0x61,0x74,0x20,0x61,0x52,0x6f,0x74,0x61,0x74,0x69,0x6f,0x6e,0x20,0x3a,
-    0x20,0x54,0x45,0x58,0x43,0x4f,0x4f,0x52,0x44,0x36,0x3b,0x0a,0x20,0x20,0x20,0x20,
-    0x66,0x6c,0x6f,0x61,0x74,0x32,0x20,0x61,0x50,0x69,0x76,0x6f,0x74,0x20,0x3a,0x20,
-    0x54,0x45,0x58,0x43,0x4f,0x4f,0x52,0x44,0x37,0x3b,0x0a,0x20,0x20,0x20,0x20,0x66,
-    0x6c,0x6f,0x61,0x74,0x34,0x20,0x61,0x54,0x69,0x6e,0x74,0x20,0x3a,0x20,0x54,0x45,
-    0x58,0x43,0x4f,0x4f,0x52,0x44,0x38,0x3b,0x0a,0x7d,0x3b,0x0a,0x0a,0x73,0x74,0x72,
-    0x75,0x63,0x74,0x20,0x53,0x50,0x49,0x52,0x56,0x5f,0x43,0x72,0x6f,0x73,0x73,0x5f,
-    0x4f,0x75,0x74,0x70,0x75,0x74,0x0a,0x7b,0x0a,0x20,0x20,0x20,0x20,0x66,0x6c,0x6f,
-    0x61,0x74,0x32,0x20,0x76,0x55,0x56,0x20,0x3a,0x20,0x54,0x45,0x58,0x43,0x4f,0x4f,
-    0x52,0x44,0x30,0x3b,0x0a,0x20,0x20,0x20,0x20,0x66,0x6c,0x6f,0x61,0x74,0x34,0x20,
-    0x76,0x54,0x69,0x6e,0x74,0x20,0x3a,0x20,0x54,0x45,0x58,0x43,0x4f,0x4f,0x52,0x44,
-    0x31,0x3b,0x0a,0x20,0x20,0x20,0x20,0x66,0x6c,0x6f,0x61,0x74,0x34,0x20,0x67,0x6c,
-    0x5f,0x50,0x6f,0x73,0x69,0x74,0x69,0x6f,0x6e,0x20,0x3a,0x20,0x53,0x56,0x5f,0x50,
-    0x6f,0x73,0x69,0x74,0x69,0x6f,0x6e,0x3b,0x0a,0x7d,0x3b,0x0a,0x0a,0x76,0x6f,0x69,
-    0x64,0x20,0x76,0x65,0x72,0x74,0x5f,0x6d,0x61,0x69,0x6e,0x28,0x29,0x0a,0x7b,0x0a,
-    0x20,0x20,0x20,0x20,0x66,0x6c,0x6f,0x61,0x74,0x20,0x5f,0x31,0x32,0x20,0x3d,0x20,
-    0x63,0x6f,0x73,0x28,0x61,0x52,0x6f,0x74,0x61,0x74,0x69,0x6f,0x6e,0x29,0x3b,0x0a,
-    0x20,0x20,0x20,0x20,0x66,0x6c,0x6f,0x61,0x74,0x20,0x5f,0x31,0x35,0x20,0x3d,0x20,
-    0x73,0x69,0x6e,0x28,0x61,0x52,0x6f,0x74,0x61,0x74,0x69,0x6f,0x6e,0x29,0x3b,0x0a,
-    0x20,0x20,0x20,0x20,0x67,0x6c,0x5f,0x50,0x6f,0x73,0x69,0x74,0x69,0x6f,0x6e,0x20,
-    0x3d,0x20,0x6d,0x75,0x6c,0x28,0x66,0x6c,0x6f,0x61,0x74,0x34,0x28,0x6d,0x75,0x6c,
-    0x28,0x28,0x61,0x50,0x6f,0x73,0x20,0x2d,0x20,0x61,0x50,0x69,0x76,0x6f,0x74,0x29,
-    0x20,0x2a,0x20,0x61,0x57,0x6f,0x72,0x6c,0x64,0x53,0x63,0x61,0x6c,0x65,0x2c,0x20,
-    0x66,0x6c,0x6f,0x61,0x74,0x32,0x78,0x32,0x28,0x66,0x6c,0x6f,0x61,0x74,0x32,0x28,
-    0x5f,0x31,0x32,0x2c,0x20,0x2d,0x5f,0x31,0x35,0x29,0x2c,0x20,0x66,0x6c,0x6f,0x61,
-    0x74,0x32,0x28,0x5f,0x31,0x35,0x2c,0x20,0x5f,0x31,0x32,0x29,0x29,0x29,0x20,0x2b,
-    0x20,0x61,0x4f,0x66,0x66,0x73,0x65,0x74,0x2c,0x20,0x30,0x2e,0x30,0x66,0x2c,0x20,
-    0x31,0x2e,0x30,0x66,0x29,0x2c,0x20,0x5f,0x36,0x34,0x5f,0x6d,0x76,0x70,0x29,0x3b,
-    0x0a,0x20,0x20,0x20,0x20,0x76,0x55,0x56,0x20,0x3d,0x20,0x61,0x55,0x56,0x4f,0x66,
-    0x66,0x73,0x65,0x74,0x20,0x2b,0x20,0x28,0x61,0x55,0x56,0x20,0x2a,0x20,0x61,0x55,
-    0x56,0x53,0x63,0x61,0x6c,0x65,0x29,0x3b,0x0a,0x20,0x20,0x20,0x20,0x76,0x54,0x69,
-    0x6e,0x74,0x20,0x3d,0x20,0x61,0x54,0x69,0x6e,0x74,0x3b,0x0a,0x7d,0x0a,0x0a,0x53,
-    0x50,0x49,0x52,0x56,0x5f,0x43,0x72,0x6f,0x73,0x73,0x5f,0x4f,0x75,0x74,0x70,0x75,
-    0x74,0x20,0x6d,0x61,0x69,0x6e,0x28,0x53,0x50,0x49,0x52,0x56,0x5f,0x43,0x72,0x6f,
-    0x73,0x73,0x5f,0x49,0x6e,0x70,0x75,0x74,0x20,0x73,0x74,0x61,0x67,0x65,0x5f,0x69,
-    0x6e,0x70,0x75,0x74,0x29,0x0a,0x7b,0x0a,0x20,0x20,0x20,0x20,0x61,0x52,0x6f,0x74,
-    0x61,0x74,0x69,0x6f,0x6e,0x20,0x3d,0x20,0x73,0x74,0x61,0x67,0x65,0x5f,0x69,0x6e,
-    0x70,0x75,0x74,0x2e,0x61,0x52,0x6f,0x74,0x61,0x74,0x69,0x6f,0x6e,0x3b,0x0a,0x20,
-    0x20,0x20,0x20,0x61,0x50,0x6f,0x73,0x20,0x3d,0x20,0x73,0x74,0x61,0x67,0x65,0x5f,
-    0x69,0x6e,0x70,0x75,0x74,0x2e,0x61,0x50,0x6f,0x73,0x3b,0x0a,0x20,0x20,0x20,0x20,
-    0x61,0x50,0x69,0x76,0x6f,0x74,0x20,0x3d,0x20,0x73,0x74,0x61,0x67,0x65,0x5f,0x69,
-    0x6e,0x70,0x75,0x74,0x2e,0x61,0x50,0x69,0x76,0x6f,0x74,0x3b,0x0a,0x20,0x20,0x20,
-    0x20,0x61,0x57,0x6f,0x72,0x6c,0x64,0x53,0x63,0x61,0x6c,0x65,0x20,0x3d,0x20,0x73,
-    0x74,0x61,0x67,0x65,0x5f,0x69,0x6e,0x70,0x75,0x74,0x2e,0x61,0x57,0x6f,0x72,0x6c,
-    0x64,0x53,0x63,0x61,0x6c,0x65,0x3b,0x0a,0x20,0x20,0x20,0x20,0x61,0x4f,0x66,0x66,
-    0x73,0x65,0x74,0x20,0x3d,0x20,0x73,0x74,0x61,0x67,0x65,0x5f,0x69,0x6e,0x70,0x75,
-    0x74,0x2e,0x61,0x4f,0x66,0x66,0x73,0x65,0x74,0x3b,0x0a,0x20,0x20,0x20,0x20,0x61,
-    0x55,0x56,0x4f,0x66,0x66,0x73,0x65,0x74,0x20,0x3d,0x20,0x73,0x74,0x61,0x67,0x65,
-    0x5f,0x69,0x6e,0x70,0x75,0x74,0x2e,0x61,0x55,0x56,0x4f,0x66,0x66,0x73,0x65,0x74,
-    0x3b,0x0a,0x20,0x20,0x20,0x20,0x61,0x55,0x56,0x20,0x3d,0x20,0x73,0x74,0x61,0x67,
-    0x65,0x5f,0x69,0x6e,0x70,0x75,0x74,0x2e,0x61,0x55,0x56,0x3b,0x0a,0x20,0x20,0x20,
-    0x20,0x61,0x55,0x56,0x53,0x63,0x61,0x6c,0x65,0x20,0x3d,0x20,0x73,0x74,0x61,0x67,
-    0x65,0x5f,0x69,0x6e,0x70,0x75,0x74,0x2e,0x61,0x55,0x56,0x53,0x63,0x61,0x6c,0x65,
-    0x3b,0x0a,0x20,0x20,0x20,0x20,0x61,0x54,0x69,0x6e,0x74,0x20,0x3d,0x20,0x73,0x74,
-    0x61,0x67,0x65,0x5f,0x69,0x6e,0x70,0x75,0x74,0x2e,0x61,0x54,0x69,0x6e,0x74,0x3b,
-    0x0a,0x20,0x20,0x20,0x20,0x76,0x65,0x72,0x74,0x5f,0x6d,0x61,0x69,0x6e,0x28,0x29,
-    0x3b,0x0a,0x20,0x20,0x20,0x20,0x53,0x50,0x49,0x52,0x56,0x5f,0x43,0x72,0x6f,0x73,
-    0x73,0x5f,0x4f,0x75,0x74,0x70,0x75,0x74,0x20,0x73,0x74,0x61,0x67,0x65,0x5f,0x6f,
-    0x75,0x74,0x70,0x75,0x74,0x3b,0x0a,0x20,0x20,0x20,0x20,0x73,0x74,0x61,0x67,0x65,
-    0x5f,0x6f,0x75,0x74,0x70,0x75,0x74,0x2e,0x67,0x6c,0x5f,0x50,0x6f,0x73,0x69,0x74,
-    0x69,0x6f,0x6e,0x20,0x3d,0x20,0x67,0x6c,0x5f,0x50,0x6f,0x73,0x69,0x74,0x69,0x6f,
-    0x6e,0x3b,0x0a,0x20,0x20,0x20,0x20,0x73,0x74,0x61,0x67,0x65,0x5f,0x6f,0x75,0x74,
-    0x70,0x75,0x74,0x2e,0x76,0x55,0x56,0x20,0x3d,0x20,0x76,0x55,0x56,0x3b,0x0a,0x20,
-    0x20,0x20,0x20,0x73,0x74,0x61,0x67,0x65,0x5f,0x6f,0x75,0x74,0x70,0x75,0x74,0x2e,
-    0x76,0x54,0x69,0x6e,0x74,0x20,0x3d,0x20,0x76,0x54,0x69,0x6e,0x74,0x3b,0x0a,0x20,
-    0x20,0x20,0x20,0x72,0x65,0x74,0x75,0x72,0x6e,0x20,0x73,0x74,0x61,0x67,0x65,0x5f,
-    0x6f,0x75,0x74,0x70,0x75,0x74,0x3b,0x0a,0x7d,0x0a,0x00,
-};
-/*
-    Texture2D<float4> inst_tex : register(t0);
-    SamplerState inst_smp : register(s0);
-
-    static float4 FragColor;
-    static float4 vTint;
-    static float2 vUV;
-
-    struct SPIRV_Cross_Input
-    {
-        float2 vUV : TEXCOORD0;
-        float4 vTint : TEXCOORD1;
-    };
-
-    struct SPIRV_Cross_Output
-    {
-        float4 FragColor : SV_Target0;
-    };
-
-    void frag_main()
-    {
-        FragColor = vTint * inst_tex.Sample(inst_smp, vUV);
-    }
-
-    SPIRV_Cross_Output main(SPIRV_Cross_Input stage_input)
-    {
-        vTint = stage_input.vTint;
-        vUV = stage_input.vUV;
-        frag_main();
-        SPIRV_Cross_Output stage_output;
-        stage_output.FragColor = FragColor;
-        return stage_output;
-    }
-*/
-static const uint8_t fs_inst_source_hlsl5[619] = {
-    0x54,0x65,0x78,0x74,0x75,0x72,0x65,0x32,0x44,0x3c,0x66,0x6c,0x6f,0x61,0x74,0x34,
-    0x3e,0x20,0x69,0x6e,0x73,0x74,0x5f,0x74,0x65,0x78,0x20,0x3a,0x20,0x72,0x65,0x67,
-    0x69,0x73,0x74,0x65,0x72,0x28,0x74,0x30,0x29,0x3b,0x0a,0x53,0x61,0x6d,0x70,0x6c,
-    0x65,0x72,0x53,0x74,0x61,0x74,0x65,0x20,0x69,0x6e,0x73,0x74,0x5f,0x73,0x6d,0x70,
-    0x20,0x3a,0x20,0x72,0x65,0x67,0x69,0x73,0x74,0x65,0x72,0x28,0x73,0x30,0x29,0x3b,
-    0x0a,0x0a,0x73,0x74,0x61,0x74,0x69,0x63,0x20,0x66,0x6c,0x6f,0x61,0x74,0x34,0x20,
-    0x46,0x72,0x61,0x67,0x43,0x6f,0x6c,0x6f,0x72,0x3b,0x0a,0x73,0x74,0x61,0x74,0x69,
-    0x63,0x20,0x66,0x6c,0x6f,0x61,0x74,0x34,0x20,0x76,0x54,0x69,0x6e,0x74,0x3b,0x0a,
-    0x73,0x74,0x61,0x74,0x69,0x63,0x20,0x66,0x6c,0x6f,0x61,0x74,0x32,0x20,0x76,0x55,
-    0x56,0x3b,0x0a,0x0a,0x73,0x74,0x72,0x75,0x63,0x74,0x20,0x53,0x50,0x49,0x52,0x56,
-    0x5f,0x43,0x72,0x6f,0x73,0x73,0x5f,0x49,0x6e,0x70,0x75,0x74,0x0a,0x7b,0x0a,0x20,
-    0x20,0x20,0x20,0x66,0x6c,0x6f,0x61,0x74,0x32,0x20,0x76,0x55,0x56,0x20,0x3a,0x20,
-    0x54,0x45,0x58,0x43,0x4f,0x4f,0x52,0x44,0x30,0x3b,0x0a,0x20,0x20,0x20,0x20,0x66,
-    0x6c,0x6f,0x61,0x74,0x34,0x20,0x76,0x54,0x69,0x6e,0x74,0x20,0x3a,0x20,0x54,0x45,
-    0x58,0x43,0x4f,0x4f,0x52,0x44,0x31,0x3b,0x0a,0x7d,0x3b,0x0a,0x0a,0x73,0x74,0x72,
-    0x75,0x63,0x74,0x20,0x53,0x50,0x49,0x52,0x56,0x5f,0x43,0x72,0x6f,0x73,0x73,0x5f,
-    0x4f,0x75,0x74,0x70,0x75,0x74,0x0a,0x7b,0x0a,0x20,0x20,0x20,0x20,0x66,0x6c,0x6f,
-    0x61,0x74,0x34,0x20,0x46,0x72,0x61,0x67,0x43,0x6f,0x6c,0x6f,0x72,0x20,0x3a,0x20,
-    0x53,0x56,0x5f,0x54,0x61,0x72,0x67,0x65,0x74,0x30,0x3b,0x0a,0x7d,0x3b,0x0a,0x0a,
-    0x76,0x6f,0x69,0x64,0x20,0x66,0x72,0x61,0x67,0x5f,0x6d,0x61,0x69,0x6e,0x28,0x29,
-    0x0a,0x7b,0x0a,0x20,0x20,0x20,0x20,0x46,0x72,0x61,0x67,0x43,0x6f,0x6c,0x6f,0x72,
-    0x20,0x3d,0x20,0x76,0x54,0x69,0x6e,0x74,0x20,0x2a,0x20,0x69,0x6e,0x73,0x74,0x5f,
-    0x74,0x65,0x78,0x2e,0x53,0x61,0x6d,0x70,0x6c,0x65,0x28,0x69,0x6e,0x73,0x74,0x5f,
-    0x73,0x6d,0x70,0x2c,0x20,0x76,0x55,0x56,0x29,0x3b,0x0a,0x7d,0x0a,0x0a,0x53,0x50,
-    0x49,0x52,0x56,0x5f,0x43,0x72,0x6f,0x73,0x73,0x5f,0x4f,0x75,0x74,0x70,0x75,0x74,
-    0x20,0x6d,0x61,0x69,0x6e,0x28,0x53,0x50,0x49,0x52,0x56,0x5f,0x43,0x72,0x6f,0x73,
-    0x73,0x5f,0x49,0x6e,0x70,0x75,0x74,0x20,0x73,0x74,0x61,0x67,0x65,0x5f,0x69,0x6e,
-    0x70,0x75,0x74,0x29,0x0a,0x7b,0x0a,0x20,0x20,0x20,0x20,0x76,0x54,0x69,0x6e,0x74,
-    0x20,0x3d,0x20,0x73,0x74,0x61,0x67,0x65,0x5f,0x69,0x6e,0x70,0x75,0x74,0x2e,0x76,
-    0x54,0x69,0x6e,0x74,0x3b,0x0a,0x20,0x20,0x20,0x20,0x76,0x55,0x56,0x20,0x3d,0x20,
-    0x73,0x74,0x61,0x67,0x65,0x5f,0x69,0x6e,0x70,0x75,0x74,0x2e,0x76,0x55,0x56,0x3b,
-    0x0a,0x20,0x20,0x20,0x20,0x66,0x72,0x61,0x67,0x5f,0x6d,0x61,0x69,0x6e,0x28,0x29,
-    0x3b,0x0a,0x20,0x20,0x20,0x20,0x53,0x50,0x49,0x52,0x56,0x5f,0x43,0x72,0x6f,0x73,
-    0x73,0x5f,0x4f,0x75,0x74,0x70,0x75,0x74,0x20,0x73,0x74,0x61,0x67,0x65,0x5f,0x6f,
-    0x75,0x74,0x70,0x75,0x74,0x3b,0x0a,0x20,0x20,0x20,0x20,0x73,0x74,0x61,0x67,0x65,
-    0x5f,0x6f,0x75,0x74,0x70,0x75,0x74,0x2e,0x46,0x72,0x61,0x67,0x43,0x6f,0x6c,0x6f,
-    0x72,0x20,0x3d,0x20,0x46,0x72,0x61,0x67,0x43,0x6f,0x6c,0x6f,0x72,0x3b,0x0a,0x20,
-    0x20,0x20,0x20,0x72,0x65,0x74,0x75,0x72,0x6e,0x20,0x73,0x74,0x61,0x67,0x65,0x5f,
-    0x6f,0x75,0x74,0x70,0x75,0x74,0x3b,0x0a,0x7d,0x0a,0x00,
-};
-/*
-    cbuffer text_params : register(b0)
-    {
-        row_major float4x4 _19_mvp : packoffset(c0);
-    };
-
-
-    static float4 gl_Position;
-    static float2 position;
-    static float2 uv;
-    static float2 texcoord0;
-    static float4 color;
-    static float4 color0;
-
-    struct SPIRV_Cross_Input
-    {
-        float2 position : TEXCOORD0;
-        float2 texcoord0 : TEXCOORD1;
-        float4 color0 : TEXCOORD2;
-    };
-
-    struct SPIRV_Cross_Output
-    {
-        float2 uv : TEXCOORD0;
-        float4 color : TEXCOORD1;
-        float4 gl_Position : SV_Position;
-    };
-
-    void vert_main()
-    {
-        gl_Position = mul(float4(position, 0.0f, 1.0f), _19_mvp);
-        uv = texcoord0;
-        color = color0;
-    }
-
-    SPIRV_Cross_Output main(SPIRV_Cross_Input stage_input)
-    {
-        position = stage_input.position;
-        texcoord0 = stage_input.texcoord0;
-        color0 = stage_input.color0;
-        vert_main();
-        SPIRV_Cross_Output stage_output;
-        stage_output.gl_Position = gl_Position;
-        stage_output.uv = uv;
-        stage_output.color = color;
-        return stage_output;
-    }
-*/
-static const uint8_t vs_text_source_hlsl5[959] = {
-    0x63,0x62,0x75,0x66,0x66,0x65,0x72,0x20,0x74,0x65,0x78,0x74,0x5f,0x70,0x61,0x72,
-    0x61,0x6d,0x73,0x20,0x3a,0x20,0x72,0x65,0x67,0x69,0x73,0x74,0x65,0x72,0x28,0x62,
-    0x30,0x29,0x0a,0x7b,0x0a,0x20,0x20,0x20,0x20,0x72,0x6f,0x77,0x5f,0x6d,0x61,0x6a,
-    0x6f,0x72,0x20,0x66,0x6c,0x6f,0x61,0x74,0x34,0x78,0x34,0x20,0x5f,0x31,0x39,0x5f,
-    0x6d,0x76,0x70,0x20,0x3a,0x20,0x70,0x61,0x63,0x6b,0x6f,0x66,0x66,0x73,0x65,0x74,
-    0x28,0x63,0x30,0x29,0x3b,0x0a,0x7d,0x3b,0x0a,0x0a,0x0a,0x73,0x74,0x61,0x74,0x69,
-    0x63,0x20,0x66,0x6c,0x6f,0x61,0x74,0x34,0x20,0x67,0x6c,0x5f,0x50,0x6f,0x73,0x69,
-    0x74,0x69,0x6f,0x6e,0x3b,0x0a,0x73,0x74,0x61,0x74,0x69,0x63,0x20,0x66,0x6c,0x6f,
-    0x61,0x74,0x32,0x20,0x70,0x6f,0x73,0x69,0x74,0x69,0x6f,0x6e,0x3b,0x0a,0x73,0x74,
-    0x61,0x74,0x69,0x63,0x20,0x66,0x6c,0x6f,0x61,0x74,0x32,0x20,0x75,0x76,0x3b,0x0a,
-    0x73,0x74,0x61,0x74,0x69,0x63,0x20,0x66,0x6c,0x6f,0x61,0x74,0x32,0x20,0x74,0x65,
-    0x78,0x63,0x6f,0x6f,0x72,0x64,0x30,0x3b,0x0a,0x73,0x74,0x61,0x74,0x69,0x63,0x20,
-    0x66,0x6c,0x6f,0x61,0x74,0x34,0x20,0x63,0x6f,0x6c,0x6f,0x72,0x3b,0x0a,0x73,0x74,
-    0x61,0x74,0x69,0x63,0x20,0x66,0x6c,0x6f,0x61,0x74,0x34,0x20,0x63,0x6f,0x6c,0x6f,
-    0x72,0x30,0x3b,0x0a,0x0a,0x73,0x74,0x72,0x75,0x63,0x74,0x20,0x53,0x50,0x49,0x52,
-    0x56,0x5f,0x43,0x72,0x6f,0x73,0x73,0x5f,0x49,0x6e,0x70,0x75,0x74,0x0a,0x7b,0x0a,
-    0x20,0x20,0x20,0x20,0x66,0x6c,0x6f,0x61,0x74,0x32,0x20,0x70,0x6f,0x73,0x69,0x74,
-    0x69,0x6f,0x6e,0x20,0x3a,0x20,0x54,0x45,0x58,0x43,0x4f,0x4f,0x52,0x44,0x30,0x3b,
-    0x0a,0x20,0x20,0x20,0x20,0x66,0x6c,0x6f,0x61,0x74,0x32,0x20,0x74,0x65,0x78,0x63,
-    0x6f,0x6f,0x72,0x64,0x30,0x20,0x3a,0x20,0x54,0x45,0x58,0x43,0x4f,0x4f,0x52,0x44,
-    0x31,0x3b,0x0a,0x20,0x20,0x20,0x20,0x66,0x6c,0x6f,0x61,0x74,0x34,0x20,0x63,0x6f,
-    0x6c,0x6f,0x72,0x30,0x20,0x3a,0x20,0x54,0x45,0x58,0x43,0x4f,0x4f,0x52,0x44,0x32,
-    0x3b,0x0a,0x7d,0x3b,0x0a,0x0a,0x73,0x74,0x72,0x75,0x63,0x74,0x20,0x53,0x50,0x49,
-    0x52,0x56,0x5f,0x43,0x72,0x6f,0x73,0x73,0x5f,0x4f,0x75,0x74,0x70,0x75,0x74,0x0a,
-    0x7b,0x0a,0x20,0x20,0x20,0x20,0x66,0x6c,0x6f,0x61,0x74,0x32,0x20,0x75,0x76,0x20,
-    0x3a,0x20,0x54,0x45,0x58,0x43,0x4f,0x4f,0x52,0x44,0x30,0x3b,0x0a,0x20,0x20,0x20,
-    0x20,0x66,0x6c,0x6f,0x61,0x74,0x34,0x20,0x63,0x6f,0x6c,0x6f,0x72,0x20,0x3a,0x20,
-    0x54,0x45,0x58,0x43,0x4f,0x4f,0x52,0x44,0x31,0x3b,0x0a,0x20,0x20,0x20,0x20,0x66,
-    0x6c,0x6f,0x61,0x74,0x34,0x20,0x67,0x6c,0x5f,0x50,0x6f,0x73,0x69,0x74,0x69,0x6f,
-    0x6e,0x20,0x3a,0x20,0x53,0x56,0x5f,0x50,0x6f,0x73,0x69,0x74,0x69,0x6f,0x6e,0x3b,
-    0x0a,0x7d,0x3b,0x0a,0x0a,0x76,0x6f,0x69,0x64,0x20,0x76,0x65,0x72,0x74,0x5f,0x6d,
-    0x61,0x69,0x6e,0x28,0x29,0x0a,0x7b,0x0a,0x20,0x20,0x20,0x20,0x67,0x6c,0x5f,0x50,
-    0x6f,0x73,0x69,0x74,0x69,0x6f,0x6e,0x20,0x3d,0x20,0x6d,0x75,0x6c,0x28,0x66,0x6c,
-    0x6f,0x61,0x74,0x34,0x28,0x70,0x6f,0x73,0x69,0x74,0x69,0x6f,0x6e,0x2c,0x20,0x30,
-    0x2e,0x30,0x66,0x2c,0x20,0x31,0x2e,0x30,0x66,0x29,0x2c,0x20,0x5f,0x31,0x39,0x5f,
-    0x6d,0x76,0x70,0x29,0x3b,0x0a,0x20,0x20,0x20,0x20,0x75,0x76,0x20,0x3d,0x20,0x74,
-    0x65,0x78,0x63,0x6f,0x6f,0x72,0x64,0x30,0x3b,0x0a,0x20,0x20,0x20,0x20,0x63,0x6f,
-    0x6c,0x6f,0x72,0x20,0x3d,0x20,0x63,0x6f,0x6c,0x6f,0x72,0x30,0x3b,0x0a,0x7d,0x0a,
-    0x0a,0x53,0x50,0x49,0x52,0x56,0x5f,0x43,0x72,0x6f,0x73,0x73,0x5f,0x4f,0x75,0x74,
-    0x70,0x75,0x74,0x20,0x6d,0x61,0x69,0x6e,0x28,0x53,0x50,0x49,0x52,0x56,0x5f,0x43,
-    0x72,0x6f,0x73,0x73,0x5f,0x49,0x6e,0x70,0x75,0x74,0x20,0x73,0x74,0x61,0x67,0x65,
-    0x5f,0x69,0x6e,0x70,0x75,0x74,0x29,0x0a,0x7b,0x0a,0x20,0x20,0x20,0x20,0x70,0x6f,
-    0x73,0x69,0x74,0x69,0x6f,0x6e,0x20,0x3d,0x20,0x73,0x74,0x61,0x67,0x65,0x5f,0x69,
-    0x6e,0x70,0x75,0x74,0x2e,0x70,0x6f,0x73,0x69,0x74,0x69,0x6f,0x6e,0x3b,0x0a,0x20,
-    0x20,0x20,0x20,0x74,0x65,0x78,0x63,0x6f,0x6f,0x72,0x64,0x30,0x20,0x3d,0x20,0x73,
-    0x74,0x61,0x67,0x65,0x5f,0x69,0x6e,0x70,0x75,0x74,0x2e,0x74,0x65,0x78,0x63,0x6f,
-    0x6f,0x72,0x64,0x30,0x3b,0x0a,0x20,0x20,0x20,0x20,0x63,0x6f,0x6c,0x6f,0x72,0x30,
-    0x20,0x3d,0x20,0x73,0x74,0x61,0x67,0x65,0x5f,0x69,0x6e,0x70,0x75,0x74,0x2e,0x63,
-    0x6f,0x6c,0x6f,0x72,0x30,0x3b,0x0a,0x20,0x20,0x20,0x20,0x76,0x65,0x72,0x74,0x5f,
-    0x6d,0x61,0x69,0x6e,0x28,0x29,0x3b,0x0a,0x20,0x20,0x20,0x20,0x53,0x50,0x49,0x52,
-    0x56,0x5f,0x43,0x72,0x6f,0x73,0x73,0x5f,0x4f,0x75,0x74,0x70,0x75,0x74,0x20,0x73,
-    0x74,0x61,0x67,0x65,0x5f,0x6f,0x75,0x74,0x70,0x75,0x74,0x3b,0x0a,0x20,0x20,0x20,
-    0x20,0x73,0x74,0x61,0x67,0x65,0x5f,0x6f,0x75,0x74,0x70,0x75,0x74,0x2e,0x67,0x6c,
-    0x5f,0x50,0x6f,0x73,0x69,0x74,0x69,0x6f,0x6e,0x20,0x3d,0x20,0x67,0x6c,0x5f,0x50,
-    0x6f,0x73,0x69,0x74,0x69,0x6f,0x6e,0x3b,0x0a,0x20,0x20,0x20,0x20,0x73,0x74,0x61,
-    0x67,0x65,0x5f,0x6f,0x75,0x74,0x70,0x75,0x74,0x2e,0x75,0x76,0x20,0x3d,0x20,0x75,
-    0x76,0x3b,0x0a,0x20,0x20,0x20,0x20,0x73,0x74,0x61,0x67,0x65,0x5f,0x6f,0x75,0x74,
-    0x70,0x75,0x74,0x2e,0x63,0x6f,0x6c,0x6f,0x72,0x20,0x3d,0x20,0x63,0x6f,0x6c,0x6f,
-    0x72,0x3b,0x0a,0x20,0x20,0x20,0x20,0x72,0x65,0x74,0x75,0x72,0x6e,0x20,0x73,0x74,
-    0x61,0x67,0x65,0x5f,0x6f,0x75,0x74,0x70,0x75,0x74,0x3b,0x0a,0x7d,0x0a,0x00,
-};
-/*
-    Texture2D<float4> text_tex : register(t0);
-    SamplerState text_smp : register(s1);
-
-    static float2 uv;
-    static float4 frag_color;
-    static float4 color;
-
-    struct SPIRV_Cross_Input
-    {
-        float2 uv : TEXCOORD0;
-        float4 color : TEXCOORD1;
-    };
-
-    struct SPIRV_Cross_Output
-    {
-        float4 frag_color : SV_Target0;
-    };
-
-    void frag_main()
-    {
-        frag_color = float4(color.xyz, color.w * text_tex.Sample(text_smp, uv).x);
-    }
-
-    SPIRV_Cross_Output main(SPIRV_Cross_Input stage_input)
-    {
-        uv = stage_input.uv;
-        color = stage_input.color;
-        frag_main();
-        SPIRV_Cross_Output stage_output;
-        stage_output.frag_color = frag_color;
-        return stage_output;
-    }
-*/
-static const uint8_t fs_text_source_hlsl5[642] = {
-    0x54,0x65,0x78,0x74,0x75,0x72,0x65,0x32,0x44,0x3c,0x66,0x6c,0x6f,0x61,0x74,0x34,
-    0x3e,0x20,0x74,0x65,0x78,0x74,0x5f,0x74,0x65,0x78,0x20,0x3a,0x20,0x72,0x65,0x67,
-    0x69,0x73,0x74,0x65,0x72,0x28,0x74,0x30,0x29,0x3b,0x0a,0x53,0x61,0x6d,0x70,0x6c,
-    0x65,0x72,0x53,0x74,0x61,0x74,0x65,0x20,0x74,0x65,0x78,0x74,0x5f,0x73,0x6d,0x70,
-    0x20,0x3a,0x20,0x72,0x65,0x67,0x69,0x73,0x74,0x65,0x72,0x28,0x73,0x31,0x29,0x3b,
-    0x0a,0x0a,0x73,0x74,0x61,0x74,0x69,0x63,0x20,0x66,0x6c,0x6f,0x61,0x74,0x32,0x20,
-    0x75,0x76,0x3b,0x0a,0x73,0x74,0x61,0x74,0x69,0x63,0x20,0x66,0x6c,0x6f,0x61,0x74,
-    0x34,0x20,0x66,0x72,0x61,0x67,0x5f,0x63,0x6f,0x6c,0x6f,0x72,0x3b,0x0a,0x73,0x74,
-    0x61,0x74,0x69,0x63,0x20,0x66,0x6c,0x6f,0x61,0x74,0x34,0x20,0x63,0x6f,0x6c,0x6f,
-    0x72,0x3b,0x0a,0x0a,0x73,0x74,0x72,0x75,0x63,0x74,0x20,0x53,0x50,0x49,0x52,0x56,
-    0x5f,0x43,0x72,0x6f,0x73,0x73,0x5f,0x49,0x6e,0x70,0x75,0x74,0x0a,0x7b,0x0a,0x20,
-    0x20,0x20,0x20,0x66,0x6c,0x6f,0x61,0x74,0x32,0x20,0x75,0x76,0x20,0x3a,0x20,0x54,
-    0x45,0x58,0x43,0x4f,0x4f,0x52,0x44,0x30,0x3b,0x0a,0x20,0x20,0x20,0x20,0x66,0x6c,
-    0x6f,0x61,0x74,0x34,0x20,0x63,0x6f,0x6c,0x6f,0x72,0x20,0x3a,0x20,0x54,0x45,0x58,
-    0x43,0x4f,0x4f,0x52,0x44,0x31,0x3b,0x0a,0x7d,0x3b,0x0a,0x0a,0x73,0x74,0x72,0x75,
-    0x63,0x74,0x20,0x53,0x50,0x49,0x52,0x56,0x5f,0x43,0x72,0x6f,0x73,0x73,0x5f,0x4f,
-    0x75,0x74,0x70,0x75,0x74,0x0a,0x7b,0x0a,0x20,0x20,0x20,0x20,0x66,0x6c,0x6f,0x61,
-    0x74,0x34,0x20,0x66,0x72,0x61,0x67,0x5f,0x63,0x6f,0x6c,0x6f,0x72,0x20,0x3a,0x20,
-    0x53,0x56,0x5f,0x54,0x61,0x72,0x67,0x65,0x74,0x30,0x3b,0x0a,0x7d,0x3b,0x0a,0x0a,
-    0x76,0x6f,0x69,0x64,0x20,0x66,0x72,0x61,0x67,0x5f,0x6d,0x61,0x69,0x6e,0x28,0x29,
-    0x0a,0x7b,0x0a,0x20,0x20,0x20,0x20,0x66,0x72,0x61,0x67,0x5f,0x63,0x6f,0x6c,0x6f,
-    0x72,0x20,0x3d,0x20,0x66,0x6c,0x6f,0x61,0x74,0x34,0x28,0x63,0x6f,0x6c,0x6f,0x72,
-    0x2e,0x78,0x79,0x7a,0x2c,0x20,0x63,0x6f,0x6c,0x6f,0x72,0x2e,0x77,0x20,0x2a,0x20,
-    0x74,0x65,0x78,0x74,0x5f,0x74,0x65,0x78,0x2e,0x53,0x61,0x6d,0x70,0x6c,0x65,0x28,
-    0x74,0x65,0x78,0x74,0x5f,0x73,0x6d,0x70,0x2c,0x20,0x75,0x76,0x29,0x2e,0x78,0x29,
-    0x3b,0x0a,0x7d,0x0a,0x0a,0x53,0x50,0x49,0x52,0x56,0x5f,0x43,0x72,0x6f,0x73,0x73,
-    0x5f,0x4f,0x75,0x74,0x70,0x75,0x74,0x20,0x6d,0x61,0x69,0x6e,0x28,0x53,0x50,0x49,
-    0x52,0x56,0x5f,0x43,0x72,0x6f,0x73,0x73,0x5f,0x49,0x6e,0x70,0x75,0x74,0x20,0x73,
-    0x74,0x61,0x67,0x65,0x5f,0x69,0x6e,0x70,0x75,0x74,0x29,0x0a,0x7b,0x0a,0x20,0x20,
-    0x20,0x20,0x75,0x76,0x20,0x3d,0x20,0x73,0x74,0x61,0x67,0x65,0x5f,0x69,0x6e,0x70,
-    0x75,0x74,0x2e,0x75,0x76,0x3b,0x0a,0x20,0x20,0x20,0x20,0x63,0x6f,0x6c,0x6f,0x72,
-    0x20,0x3d,0x20,0x73,0x74,0x61,0x67,0x65,0x5f,0x69,0x6e,0x70,0x75,0x74,0x2e,0x63,
-    0x6f,0x6c,0x6f,0x72,0x3b,0x0a,0x20,0x20,0x20,0x20,0x66,0x72,0x61,0x67,0x5f,0x6d,
-    0x61,0x69,0x6e,0x28,0x29,0x3b,0x0a,0x20,0x20,0x20,0x20,0x53,0x50,0x49,0x52,0x56,
-    0x5f,0x43,0x72,0x6f,0x73,0x73,0x5f,0x4f,0x75,0x74,0x70,0x75,0x74,0x20,0x73,0x74,
-    0x61,0x67,0x65,0x5f,0x6f,0x75,0x74,0x70,0x75,0x74,0x3b,0x0a,0x20,0x20,0x20,0x20,
-    0x73,0x74,0x61,0x67,0x65,0x5f,0x6f,0x75,0x74,0x70,0x75,0x74,0x2e,0x66,0x72,0x61,
-    0x67,0x5f,0x63,0x6f,0x6c,0x6f,0x72,0x20,0x3d,0x20,0x66,0x72,0x61,0x67,0x5f,0x63,
-    0x6f,0x6c,0x6f,0x72,0x3b,0x0a,0x20,0x20,0x20,0x20,0x72,0x65,0x74,0x75,0x72,0x6e,
-    0x20,0x73,0x74,0x61,0x67,0x65,0x5f,0x6f,0x75,0x74,0x70,0x75,0x74,0x3b,0x0a,0x7d,
-    0x0a,0x00,
-};
-/*
-    #include <metal_stdlib>
-    #include <simd/simd.h>
-
-    using namespace metal;
-
-    struct instance_params
-    {
-        float4x4 mvp;
-    };
+    #version 410
 
-    struct main0_out
-    {
-        float2 vUV [[user(locn0)]];
-        float4 vTint [[user(locn1)]];
-        float4 gl_Position [[position]];
-    };
+    uniform sampler2D text_tex_text_smp;
 
-    struct main0_in
-    {
-        float2 aPos [[attribute(0)]];
-        float2 aUV [[attribute(1)]];
-        float2 aOffset [[attribute(2)]];
-        float2 aUVOffset [[attribute(3)]];
-        float2 aWorldScale [[attribute(4)]];
-        float2 aUVScale [[attribute(5)]];
-        float aRotation [[attribute(6)]];
-        float2 aPivot [[attribute(7)]];
-        float4 aTint [[attribute(8)]];
-    };
+    layout(location = 0) in vec2 uv;
+    layout(location = 0) out vec4 frag_color;
+    layout(location = 1) in vec4 color;
 
-    vertex main0_out main0(main0_in in [[stage_in]], constant instance_params& _64 [[buffer(0)]])
+    void main()
     {
-        main0_out out = {};
-        float _12 = cos(in.aRotation);
-        float _15 = sin(in.aRotation);
-        out.gl_Position = _64.mvp * float4((float2x2(float2(_12, -_15), float2(_15, _12)) * ((in.aPos - in.aPivot) * in.aWorldScale)) + in.aOffset, 0.0, 1.0);
-        out.vUV = in.aUVOffset + (in.aUV * in.aUVScale);
-        out.vTint = in.aTint;
-        return out;
+        vec4 _24 = texture(text_tex_text_smp, uv);
+        float _25 = _24.x;
+        float _30 = fwidth(_25) * 0.5;
+        frag_color = vec4(color.xyz, color.w * smoothstep(0.5 - _30, 0.5 + _30, _25));
     }
 
 */
-static const uint8_t vs_inst_source_metal_macos[1042] = {
-    0x23,0x69,0x6e,0x63,0x6c,0x75,0x64,0x65,0x20,0x3c,0x6d,0x65,0x74,0x61,0x6c,0x5f,
-    0x73,0x74,0x64,0x6c,0x69,0x62,0x3e,0x0a,0x23,0x69,0x6e,0x63,0x6c,0x75,0x64,0x65,
-    0x20,0x3c,0x73,0x69,0x6d,0x64,0x2f,0x73,0x69,0x6d,0x64,0x2e,0x68,0x3e,0x0a,0x0a,
-    0x75,0x73,0x69,0x6e,0x67,0x20,0x6e,0x61,0x6d,0x65,0x73,0x70,0x61,0x63,0x65,0x20,
-    0x6d,0x65,0x74,0x61,0x6c,0x3b,0x0a,0x0a,0x73,0x74,0x72,0x75,0x63,0x74,0x20,0x69,
-    0x6e,0x73,0x74,0x61,0x6e,0x63,0x65,0x5f,0x70,0x61,0x72,0x61,0x6d,0x73,0x0a,0x7b,
-    0x0a,0x20,0x20,0x20,0x20,0x66,0x6c,0x6f,0x61,0x74,0x34,0x78,0x34,0x20,0x6d,0x76,
-    0x70,0x3b,0x0a,0x7d,0x3b,0x0a,0x0a,0x73,0x74,0x72,0x75,0x63,0x74,0x20,0x6d,0x61,
-    0x69,0x6e,0x30,0x5f,0x6f,0x75,0x74,0x0a,0x7b,0x0a,0x20,0x20,0x20,0x20,0x66,0x6c,
-    0x6f,0x61,0x74,0x32,0x20,0x76,0x55,0x56,0x20,0x5b,0x5b,0x75,0x73,0x65,0x72,0x28,
-    0x6c,0x6f,0x63,0x6e,0x30,0x29,0x5d,0x5d,0x3b,0x0a,0x20,0x20,0x20,0x20,0x66,0x6c,
-    0x6f,0x61,0x74,0x34,0x20,0x76,0x54,0x69,0x6e,0x74,0x20,0x5b,0x5b,0x75,0x73,0x65,
-    0x72,0x28,0x6c,0x6f,0x63,0x6e,0x31,0x29,0x5d,0x5d,0x3b,0x0a,0x20,0x20,0x20,0x20,
-    0x66,0x6c,0x6f,0x61,0x74,0x34,0x20,0x67,0x6c,0x5f,0x50,0x6f,0x73,0x69,0x74,0x69,
-    0x6f,0x6e,0x20,0x5b,0x5b,0x70,0x6f,0x73,0x69,0x74,0x69,0x6f,0x6e,0x5d,0x5d,0x3b,
-    0x0a,0x7d,0x3b,0x0a,0x0a,0x73,0x74,0x72,0x75,0x63,0x74,0x20,0x6d,0x61,0x69,0x6e,
-    0x30,0x5f,0x69,0x6e,0x0a,0x7b,0x0a,0x20,0x20,0x20,0x20,0x66,0x6c,0x6f,0x61,0x74,
-    0x32,0x20,0x61,0x50,0x6f,0x73,0x20,0x5b,0x5b,0x61,0x74,0x74,0x72,0x69,0x62,0x75,
-    0x74,0x65,0x28,0x30,0x29,0x5d,0x5d,0x3b,0x0a,0x20,0x20,0x20,0x20,0x66,0x6c,0x6f,
-    0x61,0x74,0x32,0x20,0x61,0x55,0x56,0x20,0x5b,0x5b,0x61,0x74,0x74,0x72,0x69,0x62,
-    0x75,0x74,0x65,0x28,0x31,0x29,0x5d,0x5d,0x3b,0x0a,0x20,0x20,0x20,0x20,0x66,0x6c,
-    0x6f,0x61,0x74,0x32,0x20,0x61,0x4f,0x66,0x66,0x73,0x65,0x74,0x20,0x5b,0x5b,0x61,
-    0x74,0x74,0x72,0x69,0x62,0x75,0x74,0x65,0x28,0x32,0x29,0x5d,0x5d,0x3b,0x0a,0x20,
-    0x20,0x20,0x20,0x66,0x6c,0x6f,0x61,0x74,0x32,0x20,0x61,0x55,0x56,0x4f,0x66,0x66,
-    0x73,0x65,0x74,0x20,0x5b,0x5b,0x61,0x74,0x74,0x72,0x69,0x62,0x75,0x74,0x65,0x28,
-    0x33,0x29,0x5d,0x5d,0x3b,0x0a,0x20,0x20,0x20,0x20,0x66,0x6c,0x6f,0x61,0x74,0x32,
-    0x20,0x61,0x57,0x6f,0x72,0x6c,0x64,0x53,0x63,0x61,0x6c,0x65,0x20,0x5b,0x5b,0x61,
-    0x74,0x74,0x72,0x69,0x62,0x75,0x74,0x65,0x28,0x34,0x29,0x5d,0x5d,0x3b,0x0a,0x20,
-    0x20,0x20,0x20,0x66,0x6c,0x6f,0x61,0x74,0x32,0x20,0x61,0x55,0x56,0x53,0x63,0x61,
-    0x6c,0x65,0x20,0x5b,0x5b,0x61,0x74,0x74,0x72,0x69,0x62,0x75,0x74,0x65,0x28,0x35,
-    0x29,0x5d,0x5d,0x3b,0x0a,0x20,0x20,0x20,0x20,0x66,0x6c,0x6f,0x61,0x74,0x20,0x61,
-    0x52,0x6f,0x74,0x61,0x74,0x69,0x6f,0x6e,0x20,0x5b,0x5b,0x61,0x74,0x74,0x72,0x69,
-    0x62,0x75,0x74,0x65,0x28,0x36,0x29,0x5d,0x5d,0x3b,0x0a,0x20,0x20,0x20,0x20,0x66,
-    0x6c,0x6f,0x61,0x74,0x32,0x20,0x61,0x50,0x69,0x76,0x6f,0x74,0x20,0x5b,0x5b,0x61,
-    0x74,0x74,0x72,0x69,0x62,0x75,0x74,0x65,0x28,0x37,0x29,0x5d,0x5d,0x3b,0x0a,0x20,
-    0x20,0x20,0x20,0x66,0x6c,0x6f,0x61,0x74,0x34,0x20,0x61,0x54,0x69,0x6e,0x74,0x20,
-    0x5b,0x5b,0x61,0x74,0x74,0x72,0x69,0x62,0x75,0x74,0x65,0x28,0x38,0x29,0x5d,0x5d,
-    0x3b,0x0a,0x7d,0x3b,0x0a,0x0a,0x76,0x65,0x72,0x74,0x65,0x78,0x20,0x6d,0x61,0x69,
-    0x6e,0x30,0x5f,0x6f,0x75,0x74,0x20,0x6d,0x61,0x69,0x6e,0x30,0x28,0x6d,0x61,0x69,
-    0x6e,0x30,0x5f,0x69,0x6e,0x20,0x69,0x6e,0x20,0x5b,0x5b,0x73,0x74,0x61,0x67,0x65,
-    0x5f,0x69,0x6e,0x5d,0x5d,0x2c,0x20,0x63,0x6f,0x6e,0x73,0x74,0x61,0x6e,0x74,0x20,
-    0x69,0x6e,0x73,0x74,0x61,0x6e,0x63,0x65,0x5f,0x70,0x61,0x72,0x61,0x6d,0x73,0x26,
-    0x20,0x5f,0x36,0x34,0x20,0x5b,0x5b,0x62,0x75,0x66,0x66,0x65,0x72,0x28,0x30,0x29,
-    0x5d,0x5d,0x29,0x0a,0x7b,0x0a,0x20,0x20,0x20,0x20,0x6d,0x61,0x69,0x6e,0x30,0x5f,
-    0x6f,0x75,0x74,0x20,0x6f,0x75,0x74,0x20,0x3d,0x20,0x7b,0x7d,0x3b,0x0a,0x20,0x20,
-    0x20,0x20,0x66,0x6c,0x6f,0x61,0x74,0x20,0x5f,0x31,0x32,0x20,0x3d,0x20,0x63,0x6f,
-    0x73,0x28,0x69,0x6e,0x2e,0x61,0x52,0x6f,0x74,0x61,0x74,0x69,0x6f,0x6e,0x29,0x3b,
-    0x0a,0x20,0x20,0x20,0x20,0x66,0x6c,0x6f,0x61,0x74,0x20,0x5f,0x31,0x35,0x20,0x3d,
-    0x20,0x73,0x69,0x6e,0x28,0x69,0x6e,0x2e,0x61,0x52,0x6f,0x74,0x61,0x74,0x69,0x6f,
-    0x6e,0x29,0x3b,0x0a,0x20,0x20,0x20,0x20,0x6f,0x75,0x74,0x2e,0x67,0x6c,0x5f,0x50,
-    0x6f,0x73,0x69,0x74,0x69,0x6f,0x6e,0x20,0x3d,0x20,0x5f,0x36,0x34,0x2e,0x6d,0x76,
-    0x70,0x20,0x2a,0x20,0x66,0x6c,0x6f,0x61,0x74,0x34,0x28,0x28,0x66,0x6c,0x6f,0x61,
-    0x74,0x32,0x78,0x32,0x28,0x66,0x6c,0x6f,0x61,0x74,0x32,0x28,0x5f,0x31,0x32,0x2c,
-    0x20,0x2d,0x5f,0x31,0x35,0x29,0x2c,0x20,0x66,0x6c,0x6f,0x61,0x74,0x32,0x28,0x5f,
-    0x31,0x35,0x2c,0x20,0x5f,0x31,0x32,0x29,0x29,0x20,0x2a,0x20,0x28,0x28,0x69,0x6e,
-    0x2e,0x61,0x50,0x6f,0x73,0x20,0x2d,0x20,0x69,0x6e,0x2e,0x61,0x50,0x69,0x76,0x6f,
-    0x74,0x29,0x20,0x2a,0x20,0x69,0x6e,0x2e,0x61,0x57,0x6f,0x72,0x6c,0x64,0x53,0x63,
-    0x61,0x6c,0x65,0x29,0x29,0x20,0x2b,0x20,0x69,0x6e,0x2e,0x61,0x4f,0x66,0x66,0x73,
-    0x65,0x74,0x2c,0x20,0x30,0x2e,0x30,0x2c,0x20,0x31,0x2e,0x30,0x29,0x3b,0x0a,0x20,
-    0x20,0x20,0x20,0x6f,0x75,0x74,0x2e,0x76,0x55,0x56,0x20,0x3d,0x20,0x69,0x6e,0x2e,
-    0x61,0x55,0x56,0x4f,0x66,0x66,0x73,0x65,0x74,0x20,0x2b,0x20,0x28,0x69,0x6e,0x2e,
-    0x61,0x55,0x56,0x20,0x2a,0x20,0x69,0x6e,0x2e,0x61,0x55,0x56,0x53,0x63,0x61,0x6c,
-    0x65,0x29,0x3b,0x0a,0x20,0x20,0x20,0x20,0x6f,0x75,0x74,0x2e,0x76,0x54,0x69,0x6e,
-    0x74,0x20,0x3d,0x20,0x69,0x6e,0x2e,0x61,0x54,0x69,0x6e,0x74,0x3b,0x0a,0x20,0x20,
-    0x20,0x20,0x72,0x65,0x74,0x75,0x72,0x6e,0x20,0x6f,0x75,0x74,0x3b,0x0a,0x7d,0x0a,
+static const uint8_t fs_text_sdf_source_glsl410[370] = {
+    0x23,0x76,0x65,0x72,0x73,0x69,0x6f,0x6e,0x20,0x34,0x31,0x30,0x0a,0x0a,0x75,0x6e,
+    0x69,0x66,0x6f,0x72,0x6d,0x20,0x73,0x61,0x6d,0x70,0x6c,0x65,0x72,0x32,0x44,0x20,
+    0x74,0x65,0x78,0x74,0x5f,0x74,0x65,0x78,0x5f,0x74,0x65,0x78,0x74,0x5f,0x73,0x6d,
+    0x70,0x3b,0x0a,0x0a,0x6c,0x61,0x79,0x6f,0x75,0x74,0x28,0x6c,0x6f,0x63,0x61,0x74,
+    0x69,0x6f,0x6e,0x20,0x3d,0x20,0x30,0x29,0x20,0x69,0x6e,0x20,0x76,0x65,0x63,0x32,
+    0x20,0x75,0x76,0x3b,0x0a,0x6c,0x61,0x79,0x6f,0x75,0x74,0x28,0x6c,0x6f,0x63,0x61,
+    0x74,0x69,0x6f,0x6e,0x20,0x3d,0x20,0x30,0x29,0x20,0x6f,0x75,0x74,0x20,0x76,0x65,
+    0x63,0x34,0x20,0x66,0x72,0x61,0x67,0x5f,0x63,0x6f,0x6c,0x6f,0x72,0x3b,0x0a,0x6c,
+    0x61,0x79,0x6f,0x75,0x74,0x28,0x6c,0x6f,0x63,0x61,0x74,0x69,0x6f,0x6e,0x20,0x3d,
+    0x20,0x31,0x29,0x20,0x69,0x6e,0x20,0x76,0x65,0x63,0x34,0x20,0x63,0x6f,0x6c,0x6f,
+    0x72,0x3b,0x0a,0x0a,0x76,0x6f,0x69,0x64,0x20,0x6d,0x61,0x69,0x6e,0x28,0x29,0x0a,
+    0x7b,0x0a,0x20,0x20,0x20,0x20,0x76,0x65,0x63,0x34,0x20,0x5f,0x32,0x34,0x20,0x3d,
+    0x20,0x74,0x65,0x78,0x74,0x75,0x72,0x65,0x28,0x74,0x65,0x78,0x74,0x5f,0x74,0x65,
+    0x78,0x5f,0x74,0x65,0x78,0x74,0x5f,0x73,0x6d,0x70,0x2c,0x20,0x75,0x76,0x29,0x3b,
+    0x0a,0x20,0x20,0x20,0x20,0x66,0x6c,0x6f,0x61,0x74,0x20,0x5f,0x32,0x35,0x20,0x3d,
+    0x20,0x5f,0x32,0x34,0x2e,0x78,0x3b,0x0a,0x20,0x20,0x20,0x20,0x66,0x6c,0x6f,0x61,
+    0x74,0x20,0x5f,0x33,0x30,0x20,0x3d,0x20,0x66,0x77,0x69,0x64,0x74,0x68,0x28,0x5f,
+    0x32,0x35,0x29,0x20,0x2a,0x20,0x30,0x2e,0x35,0x3b,0x0a,0x20,0x20,0x20,0x20,0x66,
+    0x72,0x61,0x67,0x5f,0x63,0x6f,0x6c,0x6f,0x72,0x20,0x3d,0x20,0x76,0x65,0x63,0x34,
+    0x28,0x63,0x6f,0x6c,0x6f,0x72,0x2e,0x78,0x79,0x7a,0x2c,0x20,0x63,0x6f,0x6c,0x6f,
+    0x72,0x2e,0x77,0x20,0x2a,0x20,0x73,0x6d,0x6f,0x6f,0x74,0x68,0x73,0x74,0x65,0x70,
+    0x28,0x30,0x2e,0x35,0x20,0x2d,0x20,0x5f,0x33,0x30,0x2c,0x20,0x30,0x2e,0x35,0x20,
+    0x2b,0x20,0x5f,0x33,0x30,0x2c,0x20,0x5f,0x32,0x35,0x29,0x29,0x3b,0x0a,0x7d,0x0a,
     0x0a,0x00,
 };
 /*
-    #include <metal_stdlib>
-    #include <simd/simd.h>
-
-    using namespace metal;
-
-    struct main0_out
-    {
-        float4 FragColor [[color(0)]];
-    };
-
-    struct main0_in
-    {
-        float2 vUV [[user(locn0)]];
-        float4 vTint [[user(locn1)]];
-    };
-
-    fragment main0_out main0(main0_in in [[stage_in]], texture2d<float> inst_tex [[texture(0)]], sampler inst_smp [[sampler(0)]])
-    {
-        main0_out out = {};
-        out.FragColor = in.vTint * inst_tex.sample(inst_smp, in.vUV);
-        return out;
-    }
-
-*/
-static const uint8_t fs_inst_source_metal_macos[456] = {
-    0x23,0x69,0x6e,0x63,0x6c,0x75,0x64,0x65,0x20,0x3c,0x6d,0x65,0x74,0x61,0x6c,0x5f,
-    0x73,0x74,0x64,0x6c,0x69,0x62,0x3e,0x0a,0x23,0x69,0x6e,0x63,0x6c,0x75,0x64,0x65,
-    0x20,0x3c,0x73,0x69,0x6d,0x64,0x2f,0x73,0x69,0x6d,0x64,0x2e,0x68,0x3e,0x0a,0x0a,
-    0x75,0x73,0x69,0x6e,0x67,0x20,0x6e,0x61,0x6d,0x65,0x73,0x70,0x61,0x63,0x65,0x20,
-    0x6d,0x65,0x74,0x61,0x6c,0x3b,0x0a,0x0a,0x73,0x74,0x72,0x75,0x63,0x74,0x20,0x6d,
-    0x61,0x69,0x6e,0x30,0x5f,0x6f,0x75,0x74,0x0a,0x7b,0x0a,0x20,0x20,0x20,0x20,0x66,
-    0x6c,0x6f,0x61,0x74,0x34,0x20,0x46,0x72,0x61,0x67,0x43,0x6f,0x6c,0x6f,0x72,0x20,
-    0x5b,0x5b,0x63,0x6f,0x6c,0x6f,0x72,0x28,0x30,0x29,0x5d,0x5d,0x3b,0x0a,0x7d,0x3b,
-    0x0a,0x0a,0x73,0x74,0x72,0x75,0x63,0x74,0x20,0x6d,0x61,0x69,0x6e,0x30,0x5f,0x69,
-    0x6e,0x0a,0x7b,0x0a,0x20,0x20,0x20,0x20,0x66,0x6c,0x6f,0x61,0x74,0x32,0x20,0x76,
-    0x55,0x56,0x20,0x5b,0x5b,0x75,0x73,0x65,0x72,0x28,0x6c,0x6f,0x63,0x6e,0x30,0x29,
-    0x5d,0x5d,0x3b,0x0a,0x20,0x20,0x20,0x20,0x66,0x6c,0x6f,0x61,0x74,0x34,0x20,0x76,
-    0x54,0x69,0x6e,0x74,0x20,0x5b,0x5b,0x75,0x73,0x65,0x72,0x28,0x6c,0x6f,0x63,0x6e,
-    0x31,0x29,0x5d,0x5d,0x3b,0x0a,0x7d,0x3b,0x0a,0x0a,0x66,0x72,0x61,0x67,0x6d,0x65,
-    0x6e,0x74,0x20,0x6d,0x61,0x69,0x6e,0x30,0x5f,0x6f,0x75,0x74,0x20,0x6d,0x61,0x69,
-    0x6e,0x30,0x28,0x6d,0x61,0x69,0x6e,0x30,0x5f,0x69,0x6e,0x20,0x69,0x6e,0x20,0x5b,
-    0x5b,0x73,0x74,0x61,0x67,0x65,0x5f,0x69,0x6e,0x5d,0x5d,0x2c,0x20,0x74,0x65,0x78,
-    0x74,0x75,0x72,0x65,0x32,0x64,0x3c,0x66,0x6c,0x6f,0x61,0x74,0x3e,0x20,0x69,0x6e,
-    0x73,0x74,0x5f,0x74,0x65,0x78,0x20,0x5b,0x5b,0x74,0x65,0x78,0x74,0x75,0x72,0x65,
-    0x28,0x30,0x29,0x5d,0x5d,0x2c,0x20,0x73,0x61,0x6d,0x70,0x6c,0x65,0x72,0x20,0x69,
-    0x6e,0x73,0x74,0x5f,0x73,0x6d,0x70,0x20,0x5b,0x5b,0x73,0x61,0x6d,0x70,0x6c,0x65,
-    0x72,0x28,0x30,0x29,0x5d,0x5d,0x29,0x0a,0x7b,0x0a,0x20,0x20,0x20,0x20,0x6d,0x61,
-    0x69,0x6e,0x30,0x5f,0x6f,0x75,0x74,0x20,0x6f,0x75,0x74,0x20,0x3d,0x20,0x7b,0x7d,
-    0x3b,0x0a,0x20,0x20,0x20,0x20,0x6f,0x75,0x74,0x2e,0x46,0x72,0x61,0x67,0x43,0x6f,
-    0x6c,0x6f,0x72,0x20,0x3d,0x20,0x69,0x6e,0x2e,0x76,0x54,0x69,0x6e,0x74,0x20,0x2a,
-    0x20,0x69,0x6e,0x73,0x74,0x5f,0x74,0x65,0x78,0x2e,0x73,0x61,0x6d,0x70,0x6c,0x65,
-    0x28,0x69,0x6e,0x73,0x74,0x5f,0x73,0x6d,0x70,0x2c,0x20,0x69,0x6e,0x2e,0x76,0x55,
-    0x56,0x29,0x3b,0x0a,0x20,0x20,0x20,0x20,0x72,0x65,0x74,0x75,0x72,0x6e,0x20,0x6f,
-    0x75,0x74,0x3b,0x0a,0x7d,0x0a,0x0a,0x00,
-};
-/*
-    #include <metal_stdlib>
-    #include <simd/simd.h>
-
-    using namespace metal;
-
-    struct text_params
-    {
-        float4x4 mvp;
-    };
-
-    struct main0_out
-    {
-        float2 uv [[user(locn0)]];
-        float4 color [[user(locn1)]];
-        float4 gl_Position [[position]];
-    };
+    #version 410
 
-    struct main0_in
-    {
-        float2 position [[attribute(0)]];
-        float2 texcoord0 [[attribute(1)]];
-        float4 color0 [[attribute(2)]];
-    };
+    uniform vec4 prim_params[4];
+    layout(location = 0) in vec3 position;
+    layout(location = 0) out vec4 color;
+    layout(location = 1) in vec4 color0;
 
-    vertex main0_out main0(main0_in in [[stage_in]], constant text_params& _19 [[buffer(0)]])
+    void main()
     {
-        main0_out out = {};
-        out.gl_Position = _19.mvp * float4(in.position, 0.0, 1.0);
-        out.uv = in.texcoord0;
-        out.color = in.color0;
-        return out;
+        gl_Position = mat4(prim_params[0], prim_params[1], prim_params[2], prim_params[3]) * vec4(position, 1.0);
+        color = color0;
     }
 
 */
-static const uint8_t vs_text_source_metal_macos[628] = {
-    0x23,0x69,0x6e,0x63,0x6c,0x75,0x64,0x65,0x20,0x3c,0x6d,0x65,0x74,0x61,0x6c,0x5f,
-    0x73,0x74,0x64,0x6c,0x69,0x62,0x3e,0x0a,0x23,0x69,0x6e,0x63,0x6c,0x75,0x64,0x65,
-    0x20,0x3c,0x73,0x69,0x6d,0x64,0x2f,0x73,0x69,0x6d,0x64,0x2e,0x68,0x3e,0x0a,0x0a,
-    0x75,0x73,0x69,0x6e,0x67,0x20,0x6e,0x61,0x6d,0x65,0x73,0x70,0x61,0x63,0x65,0x20,
-    0x6d,0x65,0x74,0x61,0x6c,0x3b,0x0a,0x0a,0x73,0x74,0x72,0x75,0x63,0x74,0x20,0x74,
-    0x65,0x78,0x74,0x5f,0x70,0x61,0x72,0x61,0x6d,0x73,0x0a,0x7b,0x0a,0x20,0x20,0x20,
-    0x20,0x66,0x6c,0x6f,0x61,0x74,0x34,0x78,0x34,0x20,0x6d,0x76,0x70,0x3b,0x0a,0x7d,
-    0x3b,0x0a,0x0a,0x73,0x74,0x72,0x75,0x63,0x74,0x20,0x6d,0x61,0x69,0x6e,0x30,0x5f,
-    0x6f,0x75,0x74,0x0a,0x7b,0x0a,0x20,0x20,0x20,0x20,0x66,0x6c,0x6f,0x61,0x74,0x32,
-    0x20,0x75,0x76,0x20,0x5b,0x5b,0x75,0x73,0x65,0x72,0x28,0x6c,0x6f,0x63,0x6e,0x30,
-    0x29,0x5d,0x5d,0x3b,0x0a,0x20,0x20,0x20,0x20,0x66,0x6c,0x6f,0x61,0x74,0x34,0x20,
-    0x63,0x6f,0x6c,0x6f,0x72,0x20,0x5b,0x5b,0x75,0x73,0x65,0x72,0x28,0x6c,0x6f,0x63,
-    0x6e,0x31,0x29,0x5d,0x5d,0x3b,0x0a,0x20,0x20,0x20,0x20,0x66,0x6c,0x6f,0x61,0x74,
-    0x34,0x20,0x67,0x6c,0x5f,0x50,0x6f,0x73,0x69,0x74,0x69,0x6f,0x6e,0x20,0x5b,0x5b,
-    0x70,0x6f,0x73,0x69,0x74,0x69,0x6f,0x6e,0x5d,0x5d,0x3b,0x0a,0x7d,0x3b,0x0a,0x0a,
-    0x73,0x74,0x72,0x75,0x63,0x74,0x20,0x6d,0x61,0x69,0x6e,0x30,0x5f,0x69,0x6e,0x0a,
-    0x7b,0x0a,0x20,0x20,0x20,0x20,0x66,0x6c,0x6f,0x61,0x74,0x32,0x20,0x70,0x6f,0x73,
-    0x69,0x74,0x69,0x6f,0x6e,0x20,0x5b,0x5b,0x61,0x74,0x74,0x72,0x69,0x62,0x75,0x74,
-    0x65,0x28,0x30,0x29,0x5d,0x5d,0x3b,0x0a,0x20,0x20,0x20,0x20,0x66,0x6c,0x6f,0x61,
-    0x74,0x32,0x20,0x74,0x65,0x78,0x63,0x6f,0x6f,0x72,0x64,0x30,0x20,0x5b,0x5b,0x61,
-    0x74,0x74,0x72,0x69,0x62,0x75,0x74,0x65,0x28,0x31,0x29,0x5d,0x5d,0x3b,0x0a,0x20,
-    0x20,0x20,0x20,0x66,0x6c,0x6f,0x61,0x74,0x34,0x20,0x63,0x6f,0x6c,0x6f,0x72,0x30,
-    0x20,0x5b,0x5b,0x61,0x74,0x74,0x72,0x69,0x62,0x75,0x74,0x65,0x28,0x32,0x29,0x5d,
-    0x5d,0x3b,0x0a,0x7d,0x3b,0x0a,0x0a,0x76,0x65,0x72,0x74,0x65,0x78,0x20,0x6d,0x61,
-    0x69,0x6e,0x30,0x5f,0x6f,0x75,0x74,0x20,0x6d,0x61,0x69,0x6e,0x30,0x28,0x6d,0x61,
-    0x69,0x6e,0x30,0x5f,0x69,0x6e,0x20,0x69,0x6e,0x20,0x5b,0x5b,0x73,0x74,0x61,0x67,
-    0x65,0x5f,0x69,0x6e,0x5d,0x5d,0x2c,0x20,0x63,0x6f,0x6e,0x73,0x74,0x61,0x6e,0x74,
-    0x20,0x74,0x65,0x78,0x74,0x5f,0x70,0x61,0x72,0x61,0x6d,0x73,0x26,0x20,0x5f,0x31,
-    0x39,0x20,0x5b,0x5b,0x62,0x75,0x66,0x66,0x65,0x72,0x28,0x30,0x29,0x5d,0x5d,0x29,
-    0x0a,0x7b,0x0a,0x20,0x20,0x20,0x20,0x6d,0x61,0x69,0x6e,0x30,0x5f,0x6f,0x75,0x74,
-    0x20,0x6f,0x75,0x74,0x20,0x3d,0x20,0x7b,0x7d,0x3b,0x0a,0x20,0x20,0x20,0x20,0x6f,
-    0x75,0x74,0x2e,0x67,0x6c,0x5f,0x50,0x6f,0x73,0x69,0x74,0x69,0x6f,0x6e,0x20,0x3d,
-    0x20,0x5f,0x31,0x39,0x2e,0x6d,0x76,0x70,0x20,0x2a,0x20,0x66,0x6c,0x6f,0x61,0x74,
-    0x34,0x28,0x69,0x6e,0x2e,0x70,0x6f,0x73,0x69,0x74,0x69,0x6f,0x6e,0x2c,0x20,0x30,
-    0x2e,0x30,0x2c,0x20,0x31,0x2e,0x30,0x29,0x3b,0x0a,0x20,0x20,0x20,0x20,0x6f,0x75,
-    0x74,0x2e,0x75,0x76,0x20,0x3d,0x20,0x69,0x6e,0x2e,0x74,0x65,0x78,0x63,0x6f,0x6f,
-    0x72,0x64,0x30,0x3b,0x0a,0x20,0x20,0x20,0x20,0x6f,0x75,0x74,0x2e,0x63,0x6f,0x6c,
-    0x6f,0x72,0x20,0x3d,0x20,0x69,0x6e,0x2e,0x63,0x6f,0x6c,0x6f,0x72,0x30,0x3b,0x0a,
-    0x20,0x20,0x20,0x20,0x72,0x65,0x74,0x75,0x72,0x6e,0x20,0x6f,0x75,0x74,0x3b,0x0a,
-    0x7d,0x0a,0x0a,0x00,
+static const uint8_t vs_prim_source_glsl410[305] = {
+    0x23,0x76,0x65,0x72,0x73,0x69,0x6f,0x6e,0x20,0x34,0x31,0x30,0x0a,0x0a,0x75,0x6e,
+    0x69,0x66,0x6f,0x72,0x6d,0x20,0x76,0x65,0x63,0x34,0x20,0x70,0x72,0x69,0x6d,0x5f,
+    0x70,0x61,0x72,0x61,0x6d,0x73,0x5b,0x34,0x5d,0x3b,0x0a,0x6c,0x61,0x79,0x6f,0x75,
+    0x74,0x28,0x6c,0x6f,0x63,0x61,0x74,0x69,0x6f,0x6e,0x20,0x3d,0x20,0x30,0x29,0x20,
+    0x69,0x6e,0x20,0x76,0x65,0x63,0x33,0x20,0x70,0x6f,0x73,0x69,0x74,0x69,0x6f,0x6e,
+    0x3b,0x0a,0x6c,0x61,0x79,0x6f,0x75,0x74,0x28,0x6c,0x6f,0x63,0x61,0x74,0x69,0x6f,
+    0x6e,0x20,0x3d,0x20,0x30,0x29,0x20,0x6f,0x75,0x74,0x20,0x76,0x65,0x63,0x34,0x20,
+    0x63,0x6f,0x6c,0x6f,0x72,0x3b,0x0a,0x6c,0x61,0x79,0x6f,0x75,0x74,0x28,0x6c,0x6f,
+    0x63,0x61,0x74,0x69,0x6f,0x6e,0x20,0x3d,0x20,0x31,0x29,0x20,0x69,0x6e,0x20,0x76,
+    0x65,0x63,0x34,0x20,0x63,0x6f,0x6c,0x6f,0x72,0x30,0x3b,0x0a,0x0a,0x76,0x6f,0x69,
+    0x64,0x20,0x6d,0x61,0x69,0x6e,0x28,0x29,0x0a,0x7b,0x0a,0x20,0x20,0x20,0x20,0x67,
+    0x6c,0x5f,0x50,0x6f,0x73,0x69,0x74,0x69,0x6f,0x6e,0x20,0x3d,0x20,0x6d,0x61,0x74,
+    0x34,0x28,0x70,0x72,0x69,0x6d,0x5f,0x70,0x61,0x72,0x61,0x6d,0x73,0x5b,0x30,0x5d,
+    0x2c,0x20,0x70,0x72,0x69,0x6d,0x5f,0x70,0x61,0x72,0x61,0x6d,0x73,0x5b,0x31,0x5d,
+    0x2c,0x20,0x70,0x72,0x69,0x6d,0x5f,0x70,0x61,0x72,0x61,0x6d,0x73,0x5b,0x32,0x5d,
+    0x2c,0x20,0x70,0x72,0x69,0x6d,0x5f,0x70,0x61,0x72,0x61,0x6d,0x73,0x5b,0x33,0x5d,
+    0x29,0x20,0x2a,0x20,0x76,0x65,0x63,0x34,0x28,0x70,0x6f,0x73,0x69,0x74,0x69,0x6f,
+    0x6e,0x2c,0x20,0x31,0x2e,0x30,0x29,0x3b,0x0a,0x20,0x20,0x20,0x20,0x63,0x6f,0x6c,
+    0x6f,0x72,0x20,0x3d,0x20,0x63,0x6f,0x6c,0x6f,0x72,0x30,0x3b,0x0a,0x7d,0x0a,0x0a,
+    0x00,
 };
 /*
-    #include <metal_stdlib>
-    #include <simd/simd.h>
-
-    using namespace metal;
-
-    struct main0_out
-    {
-        float4 frag_color [[color(0)]];
-    };
+    #version 410
 
-    struct main0_in
-    {
-        float2 uv [[user(locn0)]];
-        float4 color [[user(locn1)]];
-    };
+    layout(location = 0) out vec4 frag_color;
+    layout(location = 0) in vec4 color;
 
-    fragment main0_out main0(main0_in in [[stage_in]], texture2d<float> text_tex [[texture(0)]], sampler text_smp [[sampler(1)]])
+    void main()
     {
-        main0_out out = {};
-        out.frag_color = float4(in.color.xyz, in.color.w * text_tex.sample(text_smp, in.uv).x);
-        return out;
+        frag_color = color;
     }
 
 */
-static const uint8_t fs_text_source_metal_macos[482] = {
-    0x23,0x69,0x6e,0x63,0x6c,0x75,0x64,0x65,0x20,0x3c,0x6d,0x65,0x74,0x61,0x6c,0x5f,
-    0x73,0x74,0x64,0x6c,0x69,0x62,0x3e,0x0a,0x23,0x69,0x6e,0x63,0x6c,0x75,0x64,0x65,
-    0x20,0x3c,0x73,0x69,0x6d,0x64,0x2f,0x73,0x69,0x6d,0x64,0x2e,0x68,0x3e,0x0a,0x0a,
-    0x75,0x73,0x69,0x6e,0x67,0x20,0x6e,0x61,0x6d,0x65,0x73,0x70,0x61,0x63,0x65,0x20,
-    0x6d,0x65,0x74,0x61,0x6c,0x3b,0x0a,0x0a,0x73,0x74,0x72,0x75,0x63,0x74,0x20,0x6d,
-    0x61,0x69,0x6e,0x30,0x5f,0x6f,0x75,0x74,0x0a,0x7b,0x0a,0x20,0x20,0x20,0x20,0x66,
-    0x6c,0x6f,0x61,0x74,0x34,0x20,0x66,0x72,0x61,0x67,0x5f,0x63,0x6f,0x6c,0x6f,0x72,
-    0x20,0x5b,0x5b,0x63,0x6f,0x6c,0x6f,0x72,0x28,0x30,0x29,0x5d,0x5d,0x3b,0x0a,0x7d,
-    0x3b,0x0a,0x0a,0x73,0x74,0x72,0x75,0x63,0x74,0x20,0x6d,0x61,0x69,0x6e,0x30,0x5f,
-    0x69,0x6e,0x0a,0x7b,0x0a,0x20,0x20,0x20,0x20,0x66,0x6c,0x6f,0x61,0x74,0x32,0x20,
-    0x75,0x76,0x20,0x5b,0x5b,0x75,0x73,0x65,0x72,0x28,0x6c,0x6f,0x63,0x6e,0x30,0x29,
-    0x5d,0x5d,0x3b,0x0a,0x20,0x20,0x20,0x20,0x66,0x6c,0x6f,0x61,0x74,0x34,0x20,0x63,
-    0x6f,0x6c,0x6f,0x72,0x20,0x5b,0x5b,0x75,0x73,0x65,0x72,0x28,0x6c,0x6f,0x63,0x6e,
-    0x31,0x29,0x5d,0x5d,0x3b,0x0a,0x7d,0x3b,0x0a,0x0a,0x66,0x72,0x61,0x67,0x6d,0x65,
-    0x6e,0x74,0x20,0x6d,0x61,0x69,0x6e,0x30,0x5f,0x6f,0x75,0x74,0x20,0x6d,0x61,0x69,
-    0x6e,0x30,0x28,0x6d,0x61,0x69,0x6e,0x30,0x5f,0x69,0x6e,0x20,0x69,0x6e,0x20,0x5b,
-    0x5b,0x73,0x74,0x61,0x67,0x65,0x5f,0x69,0x6e,0x5d,0x5d,0x2c,0x20,0x74,0x65,0x78,
-    0x74,0x75,0x72,0x65,0x32,0x64,0x3c,0x66,0x6c,0x6f,0x61,0x74,0x3e,0x20,0x74,0x65,
-    0x78,0x74,0x5f,0x74,0x65,0x78,0x20,0x5b,0x5b,0x74,0x65,0x78,0x74,0x75,0x72,0x65,
-    0x28,0x30,0x29,0x5d,0x5d,0x2c,0x20,0x73,0x61,0x6d,0x70,0x6c,0x65,0x72,0x20,0x74,
-    0x65,0x78,0x74,0x5f,0x73,0x6d,0x70,0x20,0x5b,0x5b,0x73,0x61,0x6d,0x70,0x6c,0x65,
-    0x72,0x28,0x31,0x29,0x5d,0x5d,0x29,0x0a,0x7b,0x0a,0x20,0x20,0x20,0x20,0x6d,0x61,
-    0x69,0x6e,0x30,0x5f,0x6f,0x75,0x74,0x20,0x6f,0x75,0x74,0x20,0x3d,0x20,0x7b,0x7d,
-    0x3b,0x0a,0x20,0x20,0x20,0x20,0x6f,0x75,0x74,0x2e,0x66,0x72,0x61,0x67,0x5f,0x63,
-    0x6f,0x6c,0x6f,0x72,0x20,0x3d,0x20,0x66,0x6c,0x6f,0x61,0x74,0x34,0x28,0x69,0x6e,
-    0x2e,0x63,0x6f,0x6c,0x6f,0x72,0x2e,0x78,0x79,0x7a,0x2c,0x20,0x69,0x6e,0x2e,0x63,
-    0x6f,0x6c,0x6f,0x72,0x2e,0x77,0x20,0x2a,0x20,0x74,0x65,0x78,0x74,0x5f,0x74,0x65,
-    0x78,0x2e,0x73,0x61,0x6d,0x70,0x6c,0x65,0x28,0x74,0x65,0x78,0x74,0x5f,0x73,0x6d,
-    0x70,0x2c,0x20,0x69,0x6e,0x2e,0x75,0x76,0x29,0x2e,0x78,0x29,0x3b,0x0a,0x20,0x20,
-    0x20,0x20,0x72,0x65,0x74,0x75,0x72,0x6e,0x20,0x6f,0x75,0x74,0x3b,0x0a,0x7d,0x0a,
-    0x0a,0x00,
+static const uint8_t fs_prim_source_glsl410[135] = {
+    0x23,0x76,0x65,0x72,0x73,0x69,0x6f,0x6e,0x20,0x34,0x31,0x30,0x0a,0x0a,0x6c,0x61,
+    0x79,0x6f,0x75,0x74,0x28,0x6c,0x6f,0x63,0x61,0x74,0x69,0x6f,0x6e,0x20,0x3d,0x20,
+    0x30,0x29,0x20,0x6f,0x75,0x74,0x20,0x76,0x65,0x63,0x34,0x20,0x66,0x72,0x61,0x67,
+    0x5f,0x63,0x6f,0x6c,0x6f,0x72,0x3b,0x0a,0x6c,0x61,0x79,0x6f,0x75,0x74,0x28,0x6c,
+    0x6f,0x63,0x61,0x74,0x69,0x6f,0x6e,0x20,0x3d,0x20,0x30,0x29,0x20,0x69,0x6e,0x20,
+    0x76,0x65,0x63,0x34,0x20,0x63,0x6f,0x6c,0x6f,0x72,0x3b,0x0a,0x0a,0x76,0x6f,0x69,
+    0x64,0x20,0x6d,0x61,0x69,0x6e,0x28,0x29,0x0a,0x7b,0x0a,0x20,0x20,0x20,0x20,0x66,
+    0x72,0x61,0x67,0x5f,0x63,0x6f,0x6c,0x6f,0x72,0x20,0x3d,0x20,0x63,0x6f,0x6c,0x6f,
+    0x72,0x3b,0x0a,0x7d,0x0a,0x0a,0x00,
 };
 static inline const sg_shader_desc* instance_shader_desc(sg_backend backend) {
     if (backend == SG_BACKEND_GLCORE) {
@@ -1040,23 +524,21 @@ static inline const sg_shader_desc* instance_shader_desc(sg_backend backend) {
             desc.attrs[2].base_type = SG_SHADERATTRBASETYPE_FLOAT;
             desc.attrs[2].glsl_name = "aOffset";
             desc.attrs[3].base_type = SG_SHADERATTRBASETYPE_FLOAT;
-            desc.attrs[3].glsl_name = "aUVOffset";
+            desc.attrs[3].glsl_name = "aScaleRot";
             desc.attrs[4].base_type = SG_SHADERATTRBASETYPE_FLOAT;
-            desc.attrs[4].glsl_name = "aWorldScale";
-            desc.attrs[5].base_type = SG_SHADERATTRBASETYPE_FLOAT;
-            desc.attrs[5].glsl_name = "aUVScale";
-            desc.attrs[6].base_type = SG_SHADERATTRBASETYPE_FLOAT;
-            desc.attrs[6].glsl_name = "aRotation";
-            desc.attrs[7].base_type = SG_SHADERATTRBASETYPE_FLOAT;
-            desc.attrs[7].glsl_name = "aPivot";
-            desc.attrs[8].base_type = SG_SHADERATTRBASETYPE_FLOAT;
-            desc.attrs[8].glsl_name = "aTint";
+            desc.attrs[4].glsl_name = "aTint";
             desc.uniform_blocks[0].stage = SG_SHADERSTAGE_VERTEX;
             desc.uniform_blocks[0].layout = SG_UNIFORMLAYOUT_STD140;
             desc.uniform_blocks[0].size = 64;
             desc.uniform_blocks[0].glsl_uniforms[0].type = SG_UNIFORMTYPE_FLOAT4;
             desc.uniform_blocks[0].glsl_uniforms[0].array_count = 4;
             desc.uniform_blocks[0].glsl_uniforms[0].glsl_name = "instance_params";
+            desc.uniform_blocks[1].stage = SG_SHADERSTAGE_VERTEX;
+            desc.uniform_blocks[1].layout = SG_UNIFORMLAYOUT_STD140;
+            desc.uniform_blocks[1].size = 2064;
+            desc.uniform_blocks[1].glsl_uniforms[0].type = SG_UNIFORMTYPE_FLOAT4;
+            desc.uniform_blocks[1].glsl_uniforms[0].array_count = 129;
+            desc.uniform_blocks[1].glsl_uniforms[0].glsl_name = "instance_frames";
             desc.views[0].texture.stage = SG_SHADERSTAGE_FRAGMENT;
             desc.views[0].texture.image_type = SG_IMAGETYPE_2D;
             desc.views[0].texture.sample_type = SG_IMAGESAMPLETYPE_FLOAT;
@@ -1071,97 +553,59 @@ static inline const sg_shader_desc* instance_shader_desc(sg_backend backend) {
         }
         return &desc;
     }
-    if (backend == SG_BACKEND_D3D11) {
+    return 0;
+}
+static inline const sg_shader_desc* instance_indexed_shader_desc(sg_backend backend) {
+    if (backend == SG_BACKEND_GLCORE) {
         static sg_shader_desc desc;
         static bool valid;
         if (!valid) {
             valid = true;
-            desc.vertex_func.source = (const char*)vs_inst_source_hlsl5;
-            desc.vertex_func.d3d11_target = "vs_5_0";
+            desc.vertex_func.source = (const char*)vs_inst_source_glsl410;
             desc.vertex_func.entry = "main";
-            desc.fragment_func.source = (const char*)fs_inst_source_hlsl5;
-            desc.fragment_func.d3d11_target = "ps_5_0";
+            desc.fragment_func.source = (const char*)fs_inst_indexed_source_glsl410;
             desc.fragment_func.entry = "main";
             desc.attrs[0].base_type = SG_SHADERATTRBASETYPE_FLOAT;
-            desc.attrs[0].hlsl_sem_name = "TEXCOORD";
-            desc.attrs[0].hlsl_sem_index = 0;
-            desc.attrs[1].base_type = SG_SHADERATTRBASETYPE_FLOAT;
-            desc.attrs[1].hlsl_sem_name = "TEXCOORD";
-            desc.attrs[1].hlsl_sem_index = 1;
-            desc.attrs[2].base_type = SG_SHADERATTRBASETYPE_FLOAT;
-            desc.attrs[2].hlsl_sem_name = "TEXCOORD";
-            desc.attrs[2].hlsl_sem_index = 2;
-            desc.attrs[3].base_type = SG_SHADERATTRBASETYPE_FLOAT;
-            desc.attrs[3].hlsl_sem_name = "TEXCOORD";
-            desc.attrs[3].hlsl_sem_index = 3;
-            desc.attrs[4].base_type = SG_SHADERATTRBASETYPE_FLOAT;
-            desc.attrs[4].hlsl_sem_name = "TEXCOORD";
-            desc.attrs[4].hlsl_sem_index = 4;
-            desc.attrs[5].base_type = SG_SHADERATTRBASETYPE_FLOAT;
-            desc.attrs[5].hlsl_sem_name = "TEXCOORD";
-            desc.attrs[5].hlsl_sem_index = 5;
-            desc.attrs[6].base_type = SG_SHADERATTRBASETYPE_FLOAT;
-            desc.attrs[6].hlsl_sem_name = "TEXCOORD";
-            desc.attrs[6].hlsl_sem_index = 6;
-            desc.attrs[7].base_type = SG_SHADERATTRBASETYPE_FLOAT;
-            desc.attrs[7].hlsl_sem_name = "TEXCOORD";
-            desc.attrs[7].hlsl_sem_index = 7;
-            desc.attrs[8].base_type = SG_SHADERATTRBASETYPE_FLOAT;
-            desc.attrs[8].hlsl_sem_name = "TEXCOORD";
-            desc.attrs[8].hlsl_sem_index = 8;
-            desc.uniform_blocks[0].stage = SG_SHADERSTAGE_VERTEX;
-            desc.uniform_blocks[0].layout = SG_UNIFORMLAYOUT_STD140;
-            desc.uniform_blocks[0].size = 64;
-            desc.uniform_blocks[0].hlsl_register_b_n = 0;
-            desc.views[0].texture.stage = SG_SHADERSTAGE_FRAGMENT;
-            desc.views[0].texture.image_type = SG_IMAGETYPE_2D;
-            desc.views[0].texture.sample_type = SG_IMAGESAMPLETYPE_FLOAT;
-            desc.views[0].texture.multisampled = false;
-            desc.views[0].texture.hlsl_register_t_n = 0;
-            desc.samplers[0].stage = SG_SHADERSTAGE_FRAGMENT;
-            desc.samplers[0].sampler_type = SG_SAMPLERTYPE_FILTERING;
-            desc.samplers[0].hlsl_register_s_n = 0;
-            desc.texture_sampler_pairs[0].stage = SG_SHADERSTAGE_FRAGMENT;
-            desc.texture_sampler_pairs[0].view_slot = 0;
-            desc.texture_sampler_pairs[0].sampler_slot = 0;
-            desc.label = "instance_shader";
-        }
-        return &desc;
-    }
-    if (backend == SG_BACKEND_METAL_MACOS) {
-        static sg_shader_desc desc;
-        static bool valid;
-        if (!valid) {
-            valid = true;
-            desc.vertex_func.source = (const char*)vs_inst_source_metal_macos;
-            desc.vertex_func.entry = "main0";
-            desc.fragment_func.source = (const char*)fs_inst_source_metal_macos;
-            desc.fragment_func.entry = "main0";
-            desc.attrs[0].base_type = SG_SHADERATTRBASETYPE_FLOAT;
+            desc.attrs[0].glsl_name = "aPos";
             desc.attrs[1].base_type = SG_SHADERATTRBASETYPE_FLOAT;
+            desc.attrs[1].glsl_name = "aUV";
             desc.attrs[2].base_type = SG_SHADERATTRBASETYPE_FLOAT;
+            desc.attrs[2].glsl_name = "aOffset";
             desc.attrs[3].base_type = SG_SHADERATTRBASETYPE_FLOAT;
+            desc.attrs[3].glsl_name = "aScaleRot";
             desc.attrs[4].base_type = SG_SHADERATTRBASETYPE_FLOAT;
-            desc.attrs[5].base_type = SG_SHADERATTRBASETYPE_FLOAT;
-            desc.attrs[6].base_type = SG_SHADERATTRBASETYPE_FLOAT;
-            desc.attrs[7].base_type = SG_SHADERATTRBASETYPE_FLOAT;
-            desc.attrs[8].base_type = SG_SHADERATTRBASETYPE_FLOAT;
+            desc.attrs[4].glsl_name = "aTint";
             desc.uniform_blocks[0].stage = SG_SHADERSTAGE_VERTEX;
             desc.uniform_blocks[0].layout = SG_UNIFORMLAYOUT_STD140;
             desc.uniform_blocks[0].size = 64;
-            desc.uniform_blocks[0].msl_buffer_n = 0;
+            desc.uniform_blocks[0].glsl_uniforms[0].type = SG_UNIFORMTYPE_FLOAT4;
+            desc.uniform_blocks[0].glsl_uniforms[0].array_count = 4;
+            desc.uniform_blocks[0].glsl_uniforms[0].glsl_name = "instance_params";
+            desc.uniform_blocks[1].stage = SG_SHADERSTAGE_VERTEX;
+            desc.uniform_blocks[1].layout = SG_UNIFORMLAYOUT_STD140;
+            desc.uniform_blocks[1].size = 2064;
+            desc.uniform_blocks[1].glsl_uniforms[0].type = SG_UNIFORMTYPE_FLOAT4;
+            desc.uniform_blocks[1].glsl_uniforms[0].array_count = 129;
+            desc.uniform_blocks[1].glsl_uniforms[0].glsl_name = "instance_frames";
             desc.views[0].texture.stage = SG_SHADERSTAGE_FRAGMENT;
             desc.views[0].texture.image_type = SG_IMAGETYPE_2D;
             desc.views[0].texture.sample_type = SG_IMAGESAMPLETYPE_FLOAT;
             desc.views[0].texture.multisampled = false;
-            desc.views[0].texture.msl_texture_n = 0;
+            desc.views[1].texture.stage = SG_SHADERSTAGE_FRAGMENT;
+            desc.views[1].texture.image_type = SG_IMAGETYPE_2D;
+            desc.views[1].texture.sample_type = SG_IMAGESAMPLETYPE_FLOAT;
+            desc.views[1].texture.multisampled = false;
             desc.samplers[0].stage = SG_SHADERSTAGE_FRAGMENT;
             desc.samplers[0].sampler_type = SG_SAMPLERTYPE_FILTERING;
-            desc.samplers[0].msl_sampler_n = 0;
             desc.texture_sampler_pairs[0].stage = SG_SHADERSTAGE_FRAGMENT;
             desc.texture_sampler_pairs[0].view_slot = 0;
             desc.texture_sampler_pairs[0].sampler_slot = 0;
-            desc.label = "instance_shader";
+            desc.texture_sampler_pairs[0].glsl_name = "inst_tex_inst_smp";
+            desc.texture_sampler_pairs[1].stage = SG_SHADERSTAGE_FRAGMENT;
+            desc.texture_sampler_pairs[1].view_slot = 1;
+            desc.texture_sampler_pairs[1].sampler_slot = 0;
+            desc.texture_sampler_pairs[1].glsl_name = "inst_palette_inst_smp";
+            desc.label = "instance_indexed_shader";
         }
         return &desc;
     }
@@ -1178,11 +622,13 @@ static inline const sg_shader_desc* text_shader_desc(sg_backend backend) {
             desc.fragment_func.source = (const char*)fs_text_source_glsl410;
             desc.fragment_func.entry = "main";
             desc.attrs[0].base_type = SG_SHADERATTRBASETYPE_FLOAT;
-            desc.attrs[0].glsl_name = "position";
+            desc.attrs[0].glsl_name = "corner";
             desc.attrs[1].base_type = SG_SHADERATTRBASETYPE_FLOAT;
-            desc.attrs[1].glsl_name = "texcoord0";
+            desc.attrs[1].glsl_name = "rect";
             desc.attrs[2].base_type = SG_SHADERATTRBASETYPE_FLOAT;
-            desc.attrs[2].glsl_name = "color0";
+            desc.attrs[2].glsl_name = "uv_rect";
+            desc.attrs[3].base_type = SG_SHADERATTRBASETYPE_FLOAT;
+            desc.attrs[3].glsl_name = "color0";
             desc.uniform_blocks[0].stage = SG_SHADERSTAGE_VERTEX;
             desc.uniform_blocks[0].layout = SG_UNIFORMLAYOUT_STD140;
             desc.uniform_blocks[0].size = 64;
@@ -1203,73 +649,69 @@ static inline const sg_shader_desc* text_shader_desc(sg_backend backend) {
         }
         return &desc;
     }
-    if (backend == SG_BACKEND_D3D11) {
+    return 0;
+}
+static inline const sg_shader_desc* text_sdf_shader_desc(sg_backend backend) {
+    if (backend == SG_BACKEND_GLCORE) {
         static sg_shader_desc desc;
         static bool valid;
         if (!valid) {
             valid = true;
-            desc.vertex_func.source = (const char*)vs_text_source_hlsl5;
-            desc.vertex_func.d3d11_target = "vs_5_0";
+            desc.vertex_func.source = (const char*)vs_text_source_glsl410;
             desc.vertex_func.entry = "main";
-            desc.fragment_func.source = (const char*)fs_text_source_hlsl5;
-            desc.fragment_func.d3d11_target = "ps_5_0";
+            desc.fragment_func.source = (const char*)fs_text_sdf_source_glsl410;
             desc.fragment_func.entry = "main";
             desc.attrs[0].base_type = SG_SHADERATTRBASETYPE_FLOAT;
-            desc.attrs[0].hlsl_sem_name = "TEXCOORD";
-            desc.attrs[0].hlsl_sem_index = 0;
+            desc.attrs[0].glsl_name = "corner";
             desc.attrs[1].base_type = SG_SHADERATTRBASETYPE_FLOAT;
-            desc.attrs[1].hlsl_sem_name = "TEXCOORD";
-            desc.attrs[1].hlsl_sem_index = 1;
+            desc.attrs[1].glsl_name = "rect";
             desc.attrs[2].base_type = SG_SHADERATTRBASETYPE_FLOAT;
-            desc.attrs[2].hlsl_sem_name = "TEXCOORD";
-            desc.attrs[2].hlsl_sem_index = 2;
+            desc.attrs[2].glsl_name = "uv_rect";
+            desc.attrs[3].base_type = SG_SHADERATTRBASETYPE_FLOAT;
+            desc.attrs[3].glsl_name = "color0";
             desc.uniform_blocks[0].stage = SG_SHADERSTAGE_VERTEX;
             desc.uniform_blocks[0].layout = SG_UNIFORMLAYOUT_STD140;
             desc.uniform_blocks[0].size = 64;
-            desc.uniform_blocks[0].hlsl_register_b_n = 0;
+            desc.uniform_blocks[0].glsl_uniforms[0].type = SG_UNIFORMTYPE_FLOAT4;
+            desc.uniform_blocks[0].glsl_uniforms[0].array_count = 4;
+            desc.uniform_blocks[0].glsl_uniforms[0].glsl_name = "text_params";
             desc.views[1].texture.stage = SG_SHADERSTAGE_FRAGMENT;
             desc.views[1].texture.image_type = SG_IMAGETYPE_2D;
             desc.views[1].texture.sample_type = SG_IMAGESAMPLETYPE_FLOAT;
             desc.views[1].texture.multisampled = false;
-            desc.views[1].texture.hlsl_register_t_n = 0;
             desc.samplers[1].stage = SG_SHADERSTAGE_FRAGMENT;
             desc.samplers[1].sampler_type = SG_SAMPLERTYPE_FILTERING;
-            desc.samplers[1].hlsl_register_s_n = 1;
             desc.texture_sampler_pairs[0].stage = SG_SHADERSTAGE_FRAGMENT;
             desc.texture_sampler_pairs[0].view_slot = 1;
             desc.texture_sampler_pairs[0].sampler_slot = 1;
-            desc.label = "text_shader";
+            desc.texture_sampler_pairs[0].glsl_name = "text_tex_text_smp";
+            desc.label = "text_sdf_shader";
         }
         return &desc;
     }
-    if (backend == SG_BACKEND_METAL_MACOS) {
+    return 0;
+}
+static inline const sg_shader_desc* prim_shader_desc(sg_backend backend) {
+    if (backend == SG_BACKEND_GLCORE) {
         static sg_shader_desc desc;
         static bool valid;
         if (!valid) {
             valid = true;
-            desc.vertex_func.source = (const char*)vs_text_source_metal_macos;
-            desc.vertex_func.entry = "main0";
-            desc.fragment_func.source = (const char*)fs_text_source_metal_macos;
-            desc.fragment_func.entry = "main0";
+            desc.vertex_func.source = (const char*)vs_prim_source_glsl410;
+            desc.vertex_func.entry = "main";
+            desc.fragment_func.source = (const char*)fs_prim_source_glsl410;
+            desc.fragment_func.entry = "main";
             desc.attrs[0].base_type = SG_SHADERATTRBASETYPE_FLOAT;
+            desc.attrs[0].glsl_name = "position";
             desc.attrs[1].base_type = SG_SHADERATTRBASETYPE_FLOAT;
-            desc.attrs[2].base_type = SG_SHADERATTRBASETYPE_FLOAT;
+            desc.attrs[1].glsl_name = "color0";
             desc.uniform_blocks[0].stage = SG_SHADERSTAGE_VERTEX;
             desc.uniform_blocks[0].layout = SG_UNIFORMLAYOUT_STD140;
             desc.uniform_blocks[0].size = 64;
-            desc.uniform_blocks[0].msl_buffer_n = 0;
-            desc.views[1].texture.stage = SG_SHADERSTAGE_FRAGMENT;
-            desc.views[1].texture.image_type = SG_IMAGETYPE_2D;
-            desc.views[1].texture.sample_type = SG_IMAGESAMPLETYPE_FLOAT;
-            desc.views[1].texture.multisampled = false;
-            desc.views[1].texture.msl_texture_n = 0;
-            desc.samplers[1].stage = SG_SHADERSTAGE_FRAGMENT;
-            desc.samplers[1].sampler_type = SG_SAMPLERTYPE_FILTERING;
-            desc.samplers[1].msl_sampler_n = 1;
-            desc.texture_sampler_pairs[0].stage = SG_SHADERSTAGE_FRAGMENT;
-            desc.texture_sampler_pairs[0].view_slot = 1;
-            desc.texture_sampler_pairs[0].sampler_slot = 1;
-            desc.label = "text_shader";
+            desc.uniform_blocks[0].glsl_uniforms[0].type = SG_UNIFORMTYPE_FLOAT4;
+            desc.uniform_blocks[0].glsl_uniforms[0].array_count = 4;
+            desc.uniform_blocks[0].glsl_uniforms[0].glsl_name = "prim_params";
+            desc.label = "prim_shader";
         }
         return &desc;
     }
@@ -4,9 +4,13 @@
 
 #pragma once
 
+#include <algorithm>
+#include <memory>
 #include <type_traits>
 #include <utility>
+#include <span>
 #include <string>
+#include <vector>
 
 #include <sokol/sokol_gfx.h>
 
@@ -20,21 +24,75 @@
 #include "device.hh"
 #include "../core/utils.h"
 
-#define MAX_INSTANCES (1024)
+/*
+ * Instances are streamed in fixed-size chunks, each chunk being its own vertex buffer.
+ * Chunks are created on demand, so a single renderer can submit any number of instances per frame.
+ * Every render() appends into the chunks (sg_append_buffer), so the renderer can be flushed several
+ * times per frame, eg. background sprites, then text, then foreground sprites.
+ */
+#define MAX_INSTANCES_PER_CHUNK (16384)
+
+// Sprite ids must be below this, it is also the size of the frame table in shader.glsl.
+#define MAX_SPRITES (128)
+
+// Atlas pages are at most this big per side; sprites that don't fit spill into further pages.
+#define MAX_ATLAS_SIZE (8192)
+
+// Atlas pages a renderer can draw from, as render() sorts by an 8 bit page field.
+#define MAX_ATLAS_PAGES (256)
+
+/*
+ * Every sprite is surrounded by this many copies of its edge pixels and starts on a multiple of it, so mip levels up
+ * to log2(ATLAS_GUTTER) never blend neighbouring sprites. Smaller levels only show up when sprites are a few pixels big.
+ */
+#define ATLAS_GUTTER (4)
+
+/*
+ * Palette rows available to indexed atlases, row 0 being the colours the sprites were drawn with. Instances carry
+ * their row next to the sprite id, which the compact layout stores as a half, so id + MAX_SPRITES * row stays below 2048.
+ */
+#define MAX_PALETTES (16)
 
 namespace Asura::Sprite {
 
+// Identifies the source file of a sprite, so unchanged sprites can keep their place in the atlas.
+typedef struct {
+    uint64_t size;   // file size in bytes
+    int64_t mtime;
+    uint64_t hash;   // FNV-1a of the file contents, 0 until the file has been read
+} Fingerprint;
+
 typedef struct {
     int width, height, channels;
     int x, y;
+    int page;
+    int trim_x, trim_y;   // offset of the stored pixels inside the source image
+    int trim_w, trim_h;   // size of the stored pixels, transparent borders cut off
     unsigned char* data;
     // Vec4 atlas_uvs;
     const char* name;
+    Fingerprint fingerprint;
 } Sprite;
 
+/*
+ * Pixel format of the atlas pages.
+ * RGBA8:   every texel in full, with mip levels.
+ * Indexed: one byte per texel indexing a 256 colour palette, a quarter of the memory and upload. Sprites are looked up
+ *          with nearest filtering and no mip levels, which suits pixel art. If the sprites use more than 255 colours
+ *          (index 0 is transparent) the atlas falls back to RGBA8.
+ */
+enum class AtlasFormat : uint32_t {
+    RGBA8,
+    Indexed
+};
+
 typedef struct {
-    int width, height;
-    std::string path;
+    int width, height;                               // size of every page
+    int page_count;
+    AtlasFormat format;
+    std::string cache;                               // binary page cache, see AtlasCacheHeader in sprite.cc
+    std::vector<std::vector<unsigned char>> pixels;  // per page, RGBA8 with its full mip chain or indices; released once uploaded
+    std::vector<uint32_t> palette;                   // RGBA8 colour per index of an indexed atlas
 } SpriteAtlas;
 
 class Pivot {
@@ -47,10 +105,41 @@ public:
     static Math::Vec2 TopLeft() { return {0.0, 0.0}; }
 };
 
+/*
+ * Vertex layout of the per-instance stream.
+ * Standard: 40 bytes of floats per instance.
+ * Compact:  20 bytes per instance (half-float scale and rotation, RGBA8 tint).
+ *           Scale is only exact to ~0.05% so very large sprites can be off by a fraction of a pixel.
+ * Atlas rects live in a frame table uploaded at init, so instances only carry the sprite id.
+ */
+enum class InstanceLayout {
+    Standard,
+    Compact
+};
+
+enum class Blend : uint8_t {
+    Alpha,
+    Additive,
+    Count
+};
+
+/*
+ * Draw order of a pushed sprite. render() sorts by (layer, page, blend, depth), lowest first,
+ * and sprites with equal keys keep their push order.
+ */
+typedef struct {
+    uint16_t layer = 0;
+    float depth = 0.f;
+    Blend blend = Blend::Alpha;
+} Order;
+
+class Recorder;
+
 // Sprite
 class Renderer {
 public:
-    void init(const std::string& images_dir, std::vector<ResourceDef> reg);
+    void init(const std::string& images_dir, std::vector<ResourceDef> reg, InstanceLayout layout = InstanceLayout::Standard,
+              AtlasFormat format = AtlasFormat::RGBA8);
 
     template <typename E>
     requires std::is_enum_v<E>
@@ -75,49 +164,168 @@ public:
         _push_instance(std::to_underlying(id), position, scale, rotation, pivot, pivot_px, tintv);
     }
 
+    template <typename E>
+    requires std::is_enum_v<E>
+    void push(E id, Order order,
+            Math::Vec2 position,
+            Math::Vec2 scale = {1, 1}, float rotation = 0,
+            sg_color tint = sg_white,
+            Math::Vec2 pivot = Pivot::TopLeft(), Math::Vec2 pivot_px = {0, 0})
+    {
+        Math::Vec4 tintv = {tint.r, tint.g, tint.b, tint.a};
+        _push_instance(std::to_underlying(id), position, scale, rotation, pivot, pivot_px, tintv, order);
+    }
+
+    /*
+     * Pushes ids.size() sprites in one go. Every other span either matches ids in length, holds a single value
+     * that is used for all of them, or is empty to get the default. All sprites share one pivot and one Order.
+     */
+    template <typename E>
+    requires std::is_enum_v<E>
+    void push_many(std::span<const E> ids,
+            std::span<const Math::Vec2> positions,
+            std::span<const Math::Vec2> scales = {}, std::span<const float> rotations = {},
+            std::span<const Math::Vec4> tints = {},
+            Math::Vec2 pivot = Pivot::TopLeft(), Order order = {})
+    {
+        ir.ids.resize(ids.size());
+        for (size_t i = 0; i < ids.size(); ++i) ir.ids[i] = static_cast<int>(std::to_underlying(ids[i]));
+        _push_many(ir.ids, positions, scales, rotations, tints, pivot, order);
+    }
+
+    /*
+     * A recording context for one thread, found by index. Create every context a frame needs on the thread that calls
+     * render() before jobs are dispatched; after that each context can be pushed to from its own thread without locks.
+     * render() takes the renderer's own pushes first, then each context in index order, so the result doesn't depend
+     * on thread timing.
+     */
+    Recorder& recorder(size_t index);
+
+    /*
+     * Draws everything pushed since the last render(), sorted by Order.
+     * Within a layer sprites are grouped by page and blend mode before depth, so depth only orders sprites sharing both.
+     */
     void render(Math::Mat4 view = Math::Mat4(1.f));
 
-    void resize(Math::Vec2 dim, Math::Vec2 virtual_dim) { Utils::Gfx::update_projection_matrix(dim, virtual_dim, ir.vs_params.mvp); }
+    /*
+     * Drops instances whose bounds fall outside the projection * view rect before they are uploaded.
+     * Off by default; only worth it when a good share of what is pushed is off-screen.
+     */
+    void set_culling(bool enabled) { ir.culling = enabled; }
+
+    // How the atlas mip levels are blended when sprites are drawn smaller than their size; linear by default.
+    void set_mipmap_filter(sg_filter filter);
+
+    /*
+     * Palette swaps for an indexed atlas. set_palette() fills a row with colours in the order of palette(0), so a
+     * team colour is a copy of row 0 with a few entries changed. Every row starts out as a copy of row 0.
+     * use_palette() picks the row for everything pushed after it, until it is called again. Either one logs a warning
+     * and does nothing when the row is out of range.
+     */
+    std::span<const uint32_t> palette(int row = 0) const;
+    void set_palette(int row, std::span<const uint32_t> colours);
+    void use_palette(int row);
+
+    void resize(Math::Vec2 dim, Math::Vec2 virtual_dim) { Utils::Gfx::update_projection_matrix(dim, virtual_dim, ir.projection); }
+
+    typedef struct {
+        size_t instances;  // instances drawn by the last render()
+        size_t culled;     // instances dropped by culling in the last render()
+        int chunks;        // instance buffers allocated so far
+        int draws;         // draw calls issued by the last render()
+        int renders;       // render() calls so far this frame
+        size_t bytes;      // instance bytes uploaded so far this frame
+    } Stats;
+
+    const Stats& stats() const { return ir.stats; }
 
 private:
     typedef struct {
-        Math::Vec2 offset;
-        Math::Vec2 uvOffset;
-        Math::Vec2 worldScale;
-        Math::Vec2 uvScale;
+        Math::Vec2 offset;      // position with the pivot already applied
+        Math::Vec2 scale;       // scale, rotation and frame are read as one float4
         float rotation;
-        Math::Vec2 pivot;
+        float frame;            // sprite id + MAX_SPRITES * palette row, indexes instance_frames
         Math::Vec4 tint;
     } InstanceData;
 
+    typedef struct {
+        Math::Vec2 offset;
+        uint16_t scaleRot[4];   // half scale.xy, rotation (wrapped to [-pi, pi]), frame
+        uint32_t tint;          // RGBA8
+    } CompactInstanceData;
+
+    static_assert(sizeof(CompactInstanceData) == 20);
+
+    // A range of instances appended into one chunk, drawn with a single sg_draw.
+    typedef struct {
+        size_t chunk;
+        size_t page;
+        Blend blend;
+        int offset, count;
+    } Batch;
+
+    // Where the next append goes; rewound on the first render() of each frame.
+    typedef struct {
+        size_t chunk;
+        size_t used;
+    } Ring;
+
     typedef struct {
         int width, height;
+        /*
+         * The uniform blocks make this struct 16-byte aligned. GCC 12 at -O2 then multiplies a Mat4 that sits 8 bytes
+         * off a 16-byte boundary in it with aligned SSE loads and faults, so the matrix is kept on one.
+         */
+        alignas(16) Math::Mat4 projection;
         instance_params_t vs_params;
+        instance_frames_t frames;
+        std::vector<Math::Vec2> sizes;             // per sprite id, source size in pixels
+        std::vector<Math::Vec4> trims;             // per sprite id, xy = trim offset, zw = drawn size
         std::vector<InstanceData> instances;
-        // size_t instance_count;
+        std::vector<InstanceData> sorted;
+        std::vector<uint64_t> keys, keys_tmp;      // one sort key per instance
+        std::vector<uint32_t> indices, indices_tmp;
+        std::vector<uint8_t> visible;
+        std::vector<int> ids;                      // push_many ids converted to int, reused across calls
+        std::vector<std::unique_ptr<Recorder>> recorders;
+        bool culling;
+        sg_filter mipmap_filter = SG_FILTER_LINEAR;
+        AtlasFormat format;                        // what was asked for, the atlas itself can fall back to RGBA8
+        int palette;                               // row for the next push
+        std::vector<uint32_t> palettes;            // 256 colours per row, MAX_PALETTES rows
+        sg_image palette_image;
+        std::vector<CompactInstanceData> packed;
+        InstanceLayout layout;
+        size_t stride;
+        std::vector<sg_buffer> chunks;
+        std::vector<sg_view> pages;
+        std::vector<Batch> batches;
+        Ring ring;
+        uint64_t frame = UINT64_MAX;               // Device::frame at the last render() that drew
+        Stats stats;
         bool dirty;
         sg_bindings bindings;
-        sg_pipeline pipeline;
+        sg_pipeline pipelines[static_cast<size_t>(Blend::Count)];
     } InstancedRenderer;
 
     typedef struct {
-        int sizeX, sizeY;
-        std::vector<stbrp_rect> rects;
         const std::string& out_dir;
-        int rect_count, awidth, aheight;
+        int rect_count;
     } PackDef;
 
     typedef struct {
         const Sprite& tex;
+        int id;
         Math::Vec2 position;
         Math::Vec2 scale;
         float rotation = 0.f;
         Math::Vec2 pivot;
         Math::Vec2 pivot_px;
         Math::Vec4 tint;
+        int palette = 0;
     } InstanceDef;
 
-    void _clear() { ir.instances.clear(); }
+    void _clear() { ir.instances.clear(); ir.keys.clear(); }
     
     std::vector<ResourceDef> kSpriteDefs;
     std::vector<Sprite> sprites;
@@ -129,9 +337,11 @@ private:
     void _pack(const PackDef& def);
 
     void _pack_images(const std::string& out_dir);
+    void _decode_images(const std::string& dir, const std::vector<int>& ids);
+    bool _repack_changed(const std::string& out_dir, nlohmann::json& data, int rect_count);
     void _init_images(const char* dir);
 
-    InstanceData _create_instance_data(const InstanceDef &def) {
+    InstanceData _create_instance_data(const InstanceDef &def) const {
         const Sprite& tex = def.tex;
         auto position = def.position;
         auto scale = def.scale;
@@ -142,7 +352,6 @@ private:
 
         InstanceData ret{};
 
-        Math::Vec2 sc = scale;
         Math::Vec2 pv = pivot;
 
         if (pivot_px != Math::Vec2(0, 0)) {
@@ -150,26 +359,96 @@ private:
             pv.y = pivot_px.y / static_cast<float>(tex.height);
         }
 
-        ret.pivot = pv;
+        /*
+         * The quad rotates around its pivot, so fold the pivot into the offset: offset = position - R * (pivot * worldScale).
+         * The pivot is relative to the untrimmed sprite, and the quad starts where the trimmed pixels do.
+         */
+        Math::Vec2 p = {(pv.x * tex.width - tex.trim_x) * scale.x, (pv.y * tex.height - tex.trim_y) * scale.y};
+        if (rotation != 0.f) {
+            const float c = std::cos(rotation);
+            const float s = std::sin(rotation);
+            p = {c * p.x + s * p.y, -s * p.x + c * p.y};
+        }
+        ret.offset = position - p;
+
+        ret.scale    = scale;
+        ret.rotation = rotation;
+        ret.frame    = static_cast<float>(def.id + MAX_SPRITES * def.palette);
+        ret.tint     = tint;
+        return ret;
+    }
 
-        ret.offset = position;
-        ret.worldScale.x = tex.width * sc.x;
-        ret.worldScale.y = tex.height * sc.y;
+    void _init_ir();
+    void _make_sampler();
+    void _upload_palettes();
+    void _init_frames();
+    void _grow_chunks(size_t count);
+    void _pack_compact(const InstanceData* src, size_t count);
+    void _cull();
+    bool _sort_by_key();
+    void _push_many(std::span<const int> ids, std::span<const Math::Vec2> positions, std::span<const Math::Vec2> scales,
+                    std::span<const float> rotations, std::span<const Math::Vec4> tints, Math::Vec2 pivot, const Order& order);
+    void _push_instance(int id, Math::Vec2 position, Math::Vec2 scale, float rotation, Math::Vec2 pivot, Math::Vec2 pivot_px, Math::Vec4 tint, const Order& order = {});
+    bool _new_frame();
+    void _merge_recorders();
+    void _update_ir(Math::Mat4 view);
+    void _draw_ir();
+
+    friend class Recorder;
+};
 
-        ret.tint = tint;
+// Per-thread instance buffer, obtained from Renderer::recorder() and merged by Renderer::render().
+class Recorder {
+public:
+    explicit Recorder(const Renderer& owner) : owner(owner) {}
 
-        ret.uvOffset.x = tex.x / static_cast<float>(ir.width);
-        ret.uvOffset.y = tex.y / static_cast<float>(ir.height);
-        ret.uvScale.x  = tex.width  / static_cast<float>(ir.width);
-        ret.uvScale.y  = tex.height / static_cast<float>(ir.height);
-        ret.rotation   = rotation;
-        return ret;
+    template <typename E>
+    requires std::is_enum_v<E>
+    void push(E id,
+            Math::Vec2 position,
+            Math::Vec2 scale = {1, 1}, float rotation = 0,
+            Math::Vec4 tint = {1, 1, 1, 1},
+            Math::Vec2 pivot = Pivot::TopLeft(), Math::Vec2 pivot_px = {0, 0})
+    {
+        _push_instance(std::to_underlying(id), position, scale, rotation, pivot, pivot_px, tint);
     }
 
-    void _init_ir(const std::string& path);
-    void _push_instance(int id, Math::Vec2 position, Math::Vec2 scale, float rotation, Math::Vec2 pivot, Math::Vec2 pivot_px, Math::Vec4 tint);
-    void _update_ir(Math::Mat4 projection, Math::Mat4 view);
-    void _draw_ir() const;
+    template <typename E>
+    requires std::is_enum_v<E>
+    void push(E id,
+            Math::Vec2 position,
+            Math::Vec2 scale, float rotation,
+            sg_color tint = sg_white,
+            Math::Vec2 pivot = Pivot::TopLeft(), Math::Vec2 pivot_px = {0, 0})
+    {
+        Math::Vec4 tintv = {tint.r, tint.g, tint.b, tint.a};
+        _push_instance(std::to_underlying(id), position, scale, rotation, pivot, pivot_px, tintv);
+    }
+
+    template <typename E>
+    requires std::is_enum_v<E>
+    void push(E id, Order order,
+            Math::Vec2 position,
+            Math::Vec2 scale = {1, 1}, float rotation = 0,
+            sg_color tint = sg_white,
+            Math::Vec2 pivot = Pivot::TopLeft(), Math::Vec2 pivot_px = {0, 0})
+    {
+        Math::Vec4 tintv = {tint.r, tint.g, tint.b, tint.a};
+        _push_instance(std::to_underlying(id), position, scale, rotation, pivot, pivot_px, tintv, order);
+    }
+
+    // Same as Renderer::use_palette(), for this recorder only.
+    void use_palette(int row);
+
+private:
+    const Renderer& owner;
+    int palette = 0;
+    std::vector<Renderer::InstanceData> instances;
+    std::vector<uint64_t> keys;
+
+    void _push_instance(int id, Math::Vec2 position, Math::Vec2 scale, float rotation, Math::Vec2 pivot, Math::Vec2 pivot_px, Math::Vec4 tint, const Order& order = {});
+
+    friend class Renderer;
 };
 
 } // Asura
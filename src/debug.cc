@@ -4,7 +4,13 @@
 
 #include "debug.hh"
 
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
 #include "resource.hh"
+#include "utils.h"
+#include "shaders/shader.glsl.h"
 
 /* TODO
  * This code is a bit chopped.
@@ -34,6 +40,53 @@ static void print_vector(const std::vector<std::string>& text, const std::string
 }
 
 
+typedef struct {
+    float x, y, z;
+    uint32_t color;
+} PrimitiveVertex;
+
+/*
+ * Everything drawn with the primitive calls this frame. The vectors are cleared, not freed, after each draw, so once
+ * a scene has been seen the calls only write vertices. The buffers grow to the largest frame yet.
+ * 3D lines are a stream of their own, drawn with the camera's view_projection rather than the 2D ortho projection.
+ */
+typedef struct {
+    std::vector<PrimitiveVertex> lines, triangles, lines3d;
+    sg_buffer line_buf, triangle_buf, line3d_buf;
+    size_t line_capacity, triangle_capacity, line3d_capacity;  // in vertices
+    sg_pipeline line_pip, triangle_pip;
+    Asura::Math::Mat4 projection, view, view_projection;
+    bool ready;
+} Primitives;
+
+static Primitives prims = {};
+
+// Room for n more vertices at the end of the stream, with no allocation once the stream has held that many before.
+static PrimitiveVertex* extend(std::vector<PrimitiveVertex>& stream, size_t n) {
+    const size_t at = stream.size();
+    stream.resize(at + n);
+    return stream.data() + at;
+}
+
+static void emit_line(std::vector<PrimitiveVertex>& stream, float ax, float ay, float az, float bx, float by, float bz, uint32_t color) {
+    PrimitiveVertex* v = extend(stream, 2);
+    v[0] = {ax, ay, az, color};
+    v[1] = {bx, by, bz, color};
+}
+
+// A stream buffer big enough for the frame, replaced by one twice the size of what is needed when it isn't.
+static void fit(sg_buffer& buf, size_t& capacity, size_t vertices, const char* label) {
+    if (vertices <= capacity && buf.id != SG_INVALID_ID) return;
+    if (buf.id != SG_INVALID_ID) sg_destroy_buffer(buf);
+    capacity = std::bit_ceil(std::max<size_t>(vertices, 4096));
+    sg_buffer_desc desc = {};
+    desc.size = capacity * sizeof(PrimitiveVertex);
+    desc.usage.vertex_buffer = true;
+    desc.usage.stream_update = true;
+    desc.label = label;
+    buf = sg_make_buffer(&desc);
+}
+
 void Asura::Debug::print(const std::string& text, sg_color color, int font) {
     if (!Device::instance().debug) return;
     prep_color_and_font(color, font);
@@ -94,4 +147,173 @@ void Asura::Debug::resize(Math::Vec2 dim) {
     const float cy = dim.y  / dpi_scale * 1 / d;
     sdtx_canvas(cx, cy);
     sdtx_origin(1.f, 1.f);
-}
\ No newline at end of file
+}
+
+void Asura::Debug::resize(Math::Vec2 dim, Math::Vec2 virtual_dim) {
+    resize(dim);
+    Utils::Gfx::update_projection_matrix(dim, virtual_dim, prims.projection);
+}
+
+void Asura::Debug::line(Math::Vec2 a, Math::Vec2 b, sg_color color) {
+    if (!Device::instance().debug) return;
+    emit_line(prims.lines, a.x, a.y, 0.f, b.x, b.y, 0.f, Utils::Gfx::rgba8(color));
+}
+
+void Asura::Debug::line3d(Math::Vec3 a, Math::Vec3 b, sg_color color) {
+    if (!Device::instance().debug) return;
+    emit_line(prims.lines3d, a.x, a.y, a.z, b.x, b.y, b.z, Utils::Gfx::rgba8(color));
+}
+
+void Asura::Debug::lines(std::span<const Math::Vec2> points, sg_color color) {
+    if (!Device::instance().debug) return;
+    const uint32_t c = Utils::Gfx::rgba8(color);
+    const size_t n = points.size() & ~size_t{1};
+    PrimitiveVertex* v = extend(prims.lines, n);
+    for (size_t i = 0; i < n; ++i) v[i] = {points[i].x, points[i].y, 0.f, c};
+}
+
+void Asura::Debug::rect(Math::Vec2 pos, Math::Vec2 size, sg_color color, bool filled) {
+    if (!Device::instance().debug) return;
+    const uint32_t c = Utils::Gfx::rgba8(color);
+    const float x0 = pos.x, y0 = pos.y, x1 = pos.x + size.x, y1 = pos.y + size.y;
+    if (filled) {
+        PrimitiveVertex* v = extend(prims.triangles, 6);
+        v[0] = {x0, y0, 0.f, c}; v[1] = {x1, y0, 0.f, c}; v[2] = {x1, y1, 0.f, c};
+        v[3] = {x0, y0, 0.f, c}; v[4] = {x1, y1, 0.f, c}; v[5] = {x0, y1, 0.f, c};
+        return;
+    }
+    PrimitiveVertex* v = extend(prims.lines, 8);
+    v[0] = {x0, y0, 0.f, c}; v[1] = {x1, y0, 0.f, c};
+    v[2] = {x1, y0, 0.f, c}; v[3] = {x1, y1, 0.f, c};
+    v[4] = {x1, y1, 0.f, c}; v[5] = {x0, y1, 0.f, c};
+    v[6] = {x0, y1, 0.f, c}; v[7] = {x0, y0, 0.f, c};
+}
+
+void Asura::Debug::circle(Math::Vec2 centre, float radius, sg_color color, bool filled, int segments) {
+    if (!Device::instance().debug) return;
+    const uint32_t c = Utils::Gfx::rgba8(color);
+    const size_t n = static_cast<size_t>(std::max(segments, 3));
+
+    // each point is the last one turned by a fixed angle, one sin and cos per circle rather than per segment
+    const float step = 2.f * static_cast<float>(Math::pi) / static_cast<float>(n);
+    const float cs = std::cos(step), sn = std::sin(step);
+    float dx = radius, dy = 0.f;
+
+    PrimitiveVertex* v = extend(filled ? prims.triangles : prims.lines, filled ? n * 3 : n * 2);
+    for (size_t i = 0; i < n; ++i) {
+        const float nx = dx * cs - dy * sn;
+        const float ny = dx * sn + dy * cs;
+        if (filled) {
+            *v++ = {centre.x, centre.y, 0.f, c};
+            *v++ = {centre.x + dx, centre.y + dy, 0.f, c};
+            *v++ = {centre.x + nx, centre.y + ny, 0.f, c};
+        } else {
+            *v++ = {centre.x + dx, centre.y + dy, 0.f, c};
+            *v++ = {centre.x + nx, centre.y + ny, 0.f, c};
+        }
+        dx = nx;
+        dy = ny;
+    }
+}
+
+void Asura::Debug::arrow(Math::Vec2 from, Math::Vec2 to, sg_color color, float head) {
+    if (!Device::instance().debug) return;
+    const uint32_t c = Utils::Gfx::rgba8(color);
+    const Math::Vec2 dir = (to - from).normalized();
+    const Math::Vec2 back = to - dir * head;
+    const Math::Vec2 side = dir.perp() * (head * 0.5f);
+
+    PrimitiveVertex* v = extend(prims.lines, 6);
+    v[0] = {from.x, from.y, 0.f, c};
+    v[1] = {to.x, to.y, 0.f, c};
+    v[2] = {to.x, to.y, 0.f, c};
+    v[3] = {back.x + side.x, back.y + side.y, 0.f, c};
+    v[4] = {to.x, to.y, 0.f, c};
+    v[5] = {back.x - side.x, back.y - side.y, 0.f, c};
+}
+
+void Asura::Debug::aabb(Math::Vec2 min, Math::Vec2 max, sg_color color) {
+    rect(min, max - min, color);
+}
+
+void Asura::Debug::aabb3d(Math::Vec3 min, Math::Vec3 max, sg_color color) {
+    if (!Device::instance().debug) return;
+    const uint32_t c = Utils::Gfx::rgba8(color);
+    const float xs[2] = {min.x, max.x}, ys[2] = {min.y, max.y}, zs[2] = {min.z, max.z};
+
+    // corner i has bit 0 for x, bit 1 for y and bit 2 for z; every edge joins two corners one bit apart
+    PrimitiveVertex* v = extend(prims.lines3d, 24);
+    for (int i = 0; i < 8; ++i) {
+        for (int bit = 1; bit < 8; bit <<= 1) {
+            if (i & bit) continue;
+            const int j = i | bit;
+            *v++ = {xs[i & 1], ys[(i >> 1) & 1], zs[i >> 2], c};
+            *v++ = {xs[j & 1], ys[(j >> 1) & 1], zs[j >> 2], c};
+        }
+    }
+}
+
+void Asura::Debug::view(Math::Mat4 view) {
+    prims.view = view;
+}
+
+void Asura::Debug::view_projection(Math::Mat4 view_projection) {
+    prims.view_projection = view_projection;
+}
+
+void Asura::Debug::init_primitives() {
+    prims.projection = Utils::Gfx::get_default_projection(Device::instance().high_dpi ? 2 : 1);
+    prims.view = Math::Mat4(1.f);
+    prims.view_projection = Math::Mat4(1.f);
+
+    sg_shader shd = sg_make_shader(prim_shader_desc(sg_query_backend()));
+
+    sg_pipeline_desc pd = {};
+    pd.shader = shd;
+    pd.layout.attrs[ATTR_prim_position].format = SG_VERTEXFORMAT_FLOAT3;
+    pd.layout.attrs[ATTR_prim_color0].format   = SG_VERTEXFORMAT_UBYTE4N;
+    pd.colors[0].blend.enabled = true;
+    pd.colors[0].blend.src_factor_rgb = SG_BLENDFACTOR_SRC_ALPHA;
+    pd.colors[0].blend.dst_factor_rgb = SG_BLENDFACTOR_ONE_MINUS_SRC_ALPHA;
+    pd.colors[0].blend.src_factor_alpha = SG_BLENDFACTOR_ONE;
+    pd.colors[0].blend.dst_factor_alpha = SG_BLENDFACTOR_ONE_MINUS_SRC_ALPHA;
+
+    pd.primitive_type = SG_PRIMITIVETYPE_LINES;
+    pd.label = "debug-lines";
+    prims.line_pip = sg_make_pipeline(&pd);
+
+    pd.primitive_type = SG_PRIMITIVETYPE_TRIANGLES;
+    pd.label = "debug-triangles";
+    prims.triangle_pip = sg_make_pipeline(&pd);
+
+    prims.lines.reserve(4096);
+    prims.triangles.reserve(4096);
+    prims.lines3d.reserve(4096);
+    prims.ready = true;
+}
+
+void Asura::Debug::draw_primitives() {
+    if (!prims.ready || (prims.lines.empty() && prims.triangles.empty() && prims.lines3d.empty())) return;
+
+    const prim_params_t flat = {prims.projection * prims.view};
+    const prim_params_t world = {prims.view_projection};
+    const auto flush = [](std::vector<PrimitiveVertex>& stream, sg_buffer& buf, size_t& capacity, sg_pipeline pip,
+                          const prim_params_t& params, const char* label) {
+        if (stream.empty()) return;
+        fit(buf, capacity, stream.size(), label);
+        const sg_range data = {stream.data(), stream.size() * sizeof(PrimitiveVertex)};
+        sg_update_buffer(buf, &data);
+
+        sg_apply_pipeline(pip);
+        sg_bindings bind = {};
+        bind.vertex_buffers[0] = buf;
+        sg_apply_bindings(&bind);
+        sg_apply_uniforms(UB_prim_params, SG_RANGE(params));
+        sg_draw(0, static_cast<int>(stream.size()), 1);
+        stream.clear();
+    };
+    // filled shapes first, so outlines drawn over them stay visible
+    flush(prims.triangles, prims.triangle_buf, prims.triangle_capacity, prims.triangle_pip, flat, "debug-triangles");
+    flush(prims.lines, prims.line_buf, prims.line_capacity, prims.line_pip, flat, "debug-lines");
+    flush(prims.lines3d, prims.line3d_buf, prims.line3d_capacity, prims.line_pip, world, "debug-lines-3d");
+}
@@ -2,8 +2,23 @@
 // Created by Shreejit Murthy on 10/11/2025.
 //
 
+#include <atomic>
+#include <span>
+#include <thread>
+#include <unordered_set>
 #include <utility>
 
+#if defined(_WIN32)
+    #define WIN32_LEAN_AND_MEAN
+    #define NOMINMAX
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
 #include "font.hh"
 using namespace Asura::Utils;
 using namespace Asura::Utils::System;
@@ -12,359 +27,753 @@ using namespace Asura::Utils::System;
 #include <stb_truetype.h>
 #include <stb_image_write.h>
 
-#include <nlohmann/json.hpp>
-using namespace nlohmann;
+#define offsetfr(v) (int)offsetof(GlyphInstance, v)
+
+// text_params_t is laid out by hand in shader.glsl.h; it has to stay the std140 block of
+// `uniform text_params { mat4 mvp; }` in shader.glsl, which text_shader_desc() declares as 64 bytes.
+static_assert(sizeof(text_params_t) == 64 && offsetof(text_params_t, mvp) == 0);
+
+static constexpr uint32_t FONT_CACHE_VERSION = 5;
+
+// A baked glyph as stored in fonts.bin.
+typedef struct {
+    uint32_t codepoint;
+    int32_t w, h;
+    float xoff, yoff, advance;
+} CachedGlyph;
+
+// A kerning pair of the baked range as stored in fonts.bin. Pairs that don't kern are left out.
+typedef struct {
+    uint32_t first, second;
+    float kern;
+} CachedKern;
+
+/*
+ * fonts.bin: this header, a FontCacheEntry per font, then every font's glyph table, kerning pairs and glyph pixels,
+ * each on a 16 byte boundary. Nothing needs decoding, so a warm start maps the file and packs the glyphs straight from it.
+ */
+typedef struct {
+    char magic[4];       // "ASFC"
+    uint32_t version;
+    uint32_t format;     // GlyphFormat
+    uint32_t first_char, num_chars;
+    uint32_t fonts;
+    uint64_t size;       // of the whole file
+    uint64_t checksum;   // FNV-1a of everything after the header
+    uint8_t pad[24];
+} FontCacheHeader;
+
+static_assert(sizeof(FontCacheHeader) == 64);
+
+typedef struct {
+    uint64_t name_hash;  // FNV-1a of the registered name
+    uint64_t ttf_hash;   // FNV-1a of the face it was baked from
+    uint32_t pixel_size;
+    uint32_t glyphs;     // CachedGlyph count
+    uint32_t kerning;    // CachedKern count
+    uint32_t oversample;
+    uint64_t glyph_offset, kern_offset, pixel_offset, pixel_bytes;  // from the start of the file
+} FontCacheEntry;
+
+static_assert(sizeof(FontCacheEntry) == 64);
+
+// The baked range of one font, pixels back to back in table order, ready to be packed into the shared atlas.
+typedef struct {
+    std::vector<CachedGlyph> glyphs;
+    std::vector<CachedKern> kerning;
+    std::vector<std::uint8_t> pixels;
+} FontBake;
+
+// A bake as it sits in memory, owned by a FontBake or inside the mapped fonts.bin.
+typedef struct {
+    std::span<const CachedGlyph> glyphs;
+    std::span<const CachedKern> kerning;
+    std::span<const std::uint8_t> pixels;
+} FontBakeView;
+
+static uint64_t fnv1a(const std::uint8_t* bytes, size_t size) {
+    uint64_t h = 1469598103934665603ull;
+    for (size_t i = 0; i < size; ++i) { h ^= bytes[i]; h *= 1099511628211ull; }
+    return h;
+}
 
-#define offsetfr(v) (int)offsetof(Vertex, v)
+static uint64_t fnv1a(std::string_view s) {
+    return fnv1a(reinterpret_cast<const std::uint8_t*>(s.data()), s.size());
+}
 
-#define SG_VECTOR_RANGE(v) sg_range{ (v).data(), (v).size() * sizeof((v)[0]) }
+// Read-only view of a whole file, mapped where the platform can, read into memory where it can't. Empty if missing.
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path) {
+#if defined(_WIN32)
+        file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        LARGE_INTEGER size = {};
+        if (file != INVALID_HANDLE_VALUE && GetFileSizeEx(file, &size) && size.QuadPart > 0) {
+            mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            void* view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+            if (view) {
+                bytes = static_cast<const std::uint8_t*>(view);
+                length = static_cast<size_t>(size.QuadPart);
+            }
+        }
+#else
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        struct stat st = {};
+        if (fd >= 0 && ::fstat(fd, &st) == 0 && st.st_size > 0) {
+            void* view = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            if (view != MAP_FAILED) {
+                bytes = static_cast<const std::uint8_t*>(view);
+                length = static_cast<size_t>(st.st_size);
+                mapped = true;
+            }
+        }
+        if (fd >= 0) ::close(fd);
+#endif
+        if (!bytes && std::filesystem::exists(path)) {
+            fallback = readFileVec(path);
+            bytes = fallback.data();
+            length = fallback.size();
+        }
+    }
 
-std::tuple<float, float> estimateGlyphCellSize(unsigned char* ttf, float pixel_h, int first_cdepnt, int num_cdepnt) {
-    stbtt_fontinfo font;
-    stbtt_InitFont(&font, ttf, stbtt_GetFontOffsetForIndex(ttf, 0));
+    ~MappedFile() {
+#if defined(_WIN32)
+        if (bytes && fallback.empty()) UnmapViewOfFile(bytes);
+        if (mapping) CloseHandle(mapping);
+        if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+#else
+        if (mapped) ::munmap(const_cast<std::uint8_t*>(bytes), length);
+#endif
+    }
 
-    float scale = stbtt_ScaleForPixelHeight(&font, pixel_h);
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const std::uint8_t* data() const { return bytes; }
+    size_t size() const { return length; }
+
+private:
+    const std::uint8_t* bytes = nullptr;
+    size_t length = 0;
+    std::vector<std::uint8_t> fallback;
+#if defined(_WIN32)
+    HANDLE file = INVALID_HANDLE_VALUE;
+    HANDLE mapping = nullptr;
+#else
+    bool mapped = false;
+#endif
+};
+
+// The entries of a mapped fonts.bin, or nothing when it is missing, from another version or format, or corrupt.
+static std::span<const FontCacheEntry> font_cache_entries(const MappedFile& file, Asura::Font::GlyphFormat format) {
+    if (file.size() < sizeof(FontCacheHeader)) return {};
+
+    const auto* header = reinterpret_cast<const FontCacheHeader*>(file.data());
+    if (std::memcmp(header->magic, "ASFC", 4) != 0 || header->version != FONT_CACHE_VERSION ||
+        static_cast<Asura::Font::GlyphFormat>(header->format) != format || header->first_char != FIRST_CHAR || header->num_chars != NUM_CHARS ||
+        header->size != file.size() || file.size() < sizeof(FontCacheHeader) + header->fonts * sizeof(FontCacheEntry)) {
+        LOGSURA_DEBUG("Font cache is from another version or glyph format, will re-bake");
+        return {};
+    }
+    if (fnv1a(file.data() + sizeof(FontCacheHeader), file.size() - sizeof(FontCacheHeader)) != header->checksum) {
+        LOGSURA_WARN("Font cache failed its checksum, will re-bake");
+        return {};
+    }
+    return {reinterpret_cast<const FontCacheEntry*>(file.data() + sizeof(FontCacheHeader)), header->fonts};
+}
 
-    float max_w = 0;
-    float max_h = 0;
+// A font's bake inside the mapped cache, checked against the bounds of the file and of the baked range.
+static bool font_cache_view(const MappedFile& file, const FontCacheEntry& e, FontBakeView& view) {
+    const auto fits = [&file](uint64_t offset, uint64_t bytes) { return offset % 16 == 0 && offset <= file.size() && bytes <= file.size() - offset; };
+    if (!fits(e.glyph_offset, e.glyphs * sizeof(CachedGlyph)) || !fits(e.kern_offset, e.kerning * sizeof(CachedKern)) ||
+        !fits(e.pixel_offset, e.pixel_bytes) || e.kerning > NUM_CHARS * NUM_CHARS) {
+        return false;
+    }
 
-    for (int i = 0; i < num_cdepnt; ++i) {
-        int point = first_cdepnt + i;
+    view.glyphs  = {reinterpret_cast<const CachedGlyph*>(file.data() + e.glyph_offset), e.glyphs};
+    view.kerning = {reinterpret_cast<const CachedKern*>(file.data() + e.kern_offset), e.kerning};
+    view.pixels  = {file.data() + e.pixel_offset, static_cast<size_t>(e.pixel_bytes)};
 
-        int x0, y0, x1, y1;
-        stbtt_GetCodepointBitmapBox(&font, point, scale, scale, &x0, &y0, &x1, &y1);
+    uint64_t total = 0;
+    for (const CachedGlyph& c : view.glyphs) {
+        if (c.w < 0 || c.h < 0 || c.w > MAX_GLYPH_ATLAS || c.h > MAX_GLYPH_ATLAS) return false;
+        total += static_cast<uint64_t>(c.w) * static_cast<uint64_t>(c.h);
+    }
+    for (const CachedKern& k : view.kerning) {
+        if (k.first < FIRST_CHAR || k.first >= FIRST_CHAR + NUM_CHARS || k.second < FIRST_CHAR || k.second >= FIRST_CHAR + NUM_CHARS) return false;
+    }
+    return total == e.pixel_bytes;
+}
 
-        auto w = static_cast<float>(x1 - x0);
-        auto h = static_cast<float>(y1 - y0);
+static void write_font_cache(const std::string& path, Asura::Font::GlyphFormat format, const std::vector<FontCacheEntry>& entries,
+                             const std::vector<FontBakeView>& bakes) {
+    const auto align = [](uint64_t offset) { return (offset + 15) & ~uint64_t{15}; };
+
+    std::vector<FontCacheEntry> table = entries;
+    uint64_t offset = sizeof(FontCacheHeader) + table.size() * sizeof(FontCacheEntry);
+    for (size_t i = 0; i < table.size(); ++i) {
+        FontCacheEntry& e = table[i];
+        e.glyphs       = static_cast<uint32_t>(bakes[i].glyphs.size());
+        e.kerning      = static_cast<uint32_t>(bakes[i].kerning.size());
+        e.pixel_bytes  = bakes[i].pixels.size();
+        e.glyph_offset = offset = align(offset);
+        e.kern_offset  = offset = align(offset + bakes[i].glyphs.size_bytes());
+        e.pixel_offset = offset = align(offset + bakes[i].kerning.size_bytes());
+        offset += e.pixel_bytes;
+    }
 
-        if (w > max_w) max_w = w;
-        if (h > max_h) max_h = h;
+    std::vector<std::uint8_t> file(offset, 0);
+    std::memcpy(file.data() + sizeof(FontCacheHeader), table.data(), table.size() * sizeof(FontCacheEntry));
+    for (size_t i = 0; i < table.size(); ++i) {
+        const FontCacheEntry& e = table[i];
+        if (!bakes[i].glyphs.empty()) std::memcpy(file.data() + e.glyph_offset, bakes[i].glyphs.data(), bakes[i].glyphs.size_bytes());
+        if (!bakes[i].kerning.empty()) std::memcpy(file.data() + e.kern_offset, bakes[i].kerning.data(), bakes[i].kerning.size_bytes());
+        if (!bakes[i].pixels.empty()) std::memcpy(file.data() + e.pixel_offset, bakes[i].pixels.data(), bakes[i].pixels.size());
     }
 
-    float padding = 0.f;
-    return {max_w + 2.f + padding, max_h + 2.f * padding};
+    FontCacheHeader header = {};
+    std::memcpy(header.magic, "ASFC", 4);
+    header.version    = FONT_CACHE_VERSION;
+    header.format     = std::to_underlying(format);
+    header.first_char = FIRST_CHAR;
+    header.num_chars  = NUM_CHARS;
+    header.fonts      = static_cast<uint32_t>(table.size());
+    header.size       = file.size();
+    header.checksum   = fnv1a(file.data() + sizeof(FontCacheHeader), file.size() - sizeof(FontCacheHeader));
+    std::memcpy(file.data(), &header, sizeof(header));
+
+    // written aside and moved over, so a crash mid-write never leaves a cache that looks valid
+    const std::string temp = path + ".tmp";
+    writeBinary(file, temp);
+    std::error_code ec;
+    std::filesystem::rename(temp, path, ec);
+    if (ec) Asura::Log::get().error("Failed to write font cache at {}: {}", path, ec.message());
 }
 
-std::tuple<int, int> estimateAtlasSize(float gw, float gh, int N) {
-    const double cols_f = std::sqrt(static_cast<double>(N) * static_cast<double>(gh) / static_cast<double>(gw));
-    const int cols = static_cast<int>(std::ceil(cols_f));
-    const int rows = static_cast<int>(std::ceil(static_cast<double>(N) / static_cast<double>(cols)));
+/*
+ * Rasterizes one glyph as the renderer's format asks, filling in g's size and offset. The pixels are g.w x g.h, null
+ * for blank glyphs, and go back through free_glyph(). Only reads the font, so fonts can be rasterized side by side.
+ */
+static unsigned char* rasterize(const Asura::Font::Font& font, Asura::Font::GlyphFormat format, uint32_t codepoint, Asura::Font::Glyph& g) {
+    const int cp = static_cast<int>(codepoint);
+    int advance = 0, lsb = 0;
+    stbtt_GetCodepointHMetrics(&font.info, cp, &advance, &lsb);
+    g.advance = advance * font.scale;
+
+    if (font.oversample > 1) {
+        // rendered wider and box filtered, so the glyph can sit between screen pixels; the quad is oversample times narrower
+        const int ox = font.oversample;
+        int x0 = 0, y0 = 0, x1 = 0, y1 = 0;
+        stbtt_GetCodepointBitmapBox(&font.info, cp, font.scale * ox, font.scale, &x0, &y0, &x1, &y1);
+        if (x1 <= x0 || y1 <= y0) {
+            g.w = g.h = 0;
+            return nullptr;
+        }
+        g.w = x1 - x0 + ox - 1;
+        g.h = y1 - y0;
+        auto* pixels = static_cast<unsigned char*>(std::calloc(static_cast<size_t>(g.w) * static_cast<size_t>(g.h), 1));
+        float sub_x = 0.f, sub_y = 0.f;
+        stbtt_MakeCodepointBitmapSubpixelPrefilter(&font.info, pixels, g.w, g.h, g.w, font.scale * ox, font.scale, 0.f, 0.f, ox, 1, &sub_x, &sub_y, cp);
+        g.xoff = static_cast<float>(x0) / static_cast<float>(ox) + sub_x;
+        g.yoff = static_cast<float>(y0) + sub_y;
+        return pixels;
+    }
 
-    int w = cols * static_cast<int>( gw);
-    int h = rows * static_cast<int>(gh);
+    int xoff = 0, yoff = 0;
+    unsigned char* pixels = nullptr;
+    if (format == Asura::Font::GlyphFormat::SDF) {
+        // 128 is the outline, and the field falls to 0 SDF_PADDING texels outside it
+        pixels = stbtt_GetCodepointSDF(&font.info, font.scale, cp, SDF_PADDING, 128, 128.f / SDF_PADDING, &g.w, &g.h, &xoff, &yoff);
+    } else {
+        pixels = stbtt_GetCodepointBitmap(&font.info, font.scale, font.scale, cp, &g.w, &g.h, &xoff, &yoff);
+    }
+    if (!pixels) g.w = g.h = 0;
+    g.xoff = static_cast<float>(xoff);
+    g.yoff = static_cast<float>(yoff);
+    return pixels;
+}
 
-    return {w, h};
+static void free_glyph(unsigned char* pixels, Asura::Font::GlyphFormat format) {
+    if (format == Asura::Font::GlyphFormat::SDF) stbtt_FreeSDF(pixels, nullptr);
+    else stbtt_FreeBitmap(pixels, nullptr);
 }
 
-inline void write_font_cache(const Asura::Font::Font& font, const std::string& path) {
-    std::ofstream out(path, std::ios::binary);
-    if (!out) {
-        std::cerr << "Error opening font cache for writing: " << path << '\n';
-        return;
+// The baked range of a font with its kerning, away from the atlas so every font can be baked on its own thread.
+static FontBake bake_font(const Asura::Font::Font& font, Asura::Font::GlyphFormat format) {
+    FontBake bake;
+    for (int c = FIRST_CHAR; c < FIRST_CHAR + NUM_CHARS; ++c) {
+        Asura::Font::Glyph g = {};
+        unsigned char* pixels = rasterize(font, format, static_cast<uint32_t>(c), g);
+        bake.glyphs.push_back({static_cast<uint32_t>(c), g.w, g.h, g.xoff, g.yoff, g.advance});
+        if (pixels) bake.pixels.insert(bake.pixels.end(), pixels, pixels + static_cast<size_t>(g.w) * static_cast<size_t>(g.h));
+        free_glyph(pixels, format);
     }
 
-    uint64_t bitmap_size = font.bitmap.size();
-    out.write(reinterpret_cast<const char*>(&bitmap_size), sizeof(bitmap_size));
-
-    if (bitmap_size > 0) {
-        out.write(reinterpret_cast<const char*>(font.bitmap.data()), bitmap_size);
+    if (font.info.kern || font.info.gpos) {
+        for (int a = FIRST_CHAR; a < FIRST_CHAR + NUM_CHARS; ++a) {
+            for (int b = FIRST_CHAR; b < FIRST_CHAR + NUM_CHARS; ++b) {
+                const int kern = stbtt_GetCodepointKernAdvance(&font.info, a, b);
+                if (kern != 0) bake.kerning.push_back({static_cast<uint32_t>(a), static_cast<uint32_t>(b), kern * font.scale});
+            }
+        }
     }
-
-    out.write(reinterpret_cast<const char*>(font.chars.data()), NUM_CHARS * sizeof(stbtt_bakedchar));
+    return bake;
 }
 
+static FontBakeView view_of(const FontBake& bake) {
+    return {bake.glyphs, bake.kerning, bake.pixels};
+}
 
-inline bool read_font_cache(Asura::Font::Font& font, const std::string& path, std::size_t expected_bitmap_size) {
-    std::ifstream in(path, std::ios::binary);
-    if (!in) {
-        std::cerr << "Error opening font cache for reading: " << path << '\n';
-        return false;
+// Next codepoint of a UTF-8 string, moving i past it. Malformed sequences come out as U+FFFD, one byte at a time.
+static uint32_t next_codepoint(std::string_view text, size_t& i) {
+    const auto byte = [text](size_t k) { return static_cast<uint32_t>(static_cast<unsigned char>(text[k])); };
+    const uint32_t b0 = byte(i);
+    if (b0 < 0x80) {
+        ++i;
+        return b0;
     }
 
-    uint64_t bitmap_size = 0;
-    in.read(reinterpret_cast<char*>(&bitmap_size), sizeof(bitmap_size));
-    if (!in) {
-        Asura::Log::get().error("Bad read on bitmap size for {} from: {}", font.name, path);
-        return false;
+    size_t len = 0;
+    uint32_t cp = 0, min = 0;
+    if      ((b0 & 0xe0) == 0xc0) { len = 2; cp = b0 & 0x1f; min = 0x80; }
+    else if ((b0 & 0xf0) == 0xe0) { len = 3; cp = b0 & 0x0f; min = 0x800; }
+    else if ((b0 & 0xf8) == 0xf0) { len = 4; cp = b0 & 0x07; min = 0x10000; }
+
+    bool valid = len != 0 && i + len <= text.size();
+    for (size_t k = 1; valid && k < len; ++k) {
+        const uint32_t b = byte(i + k);
+        valid = (b & 0xc0) == 0x80;
+        cp = (cp << 6) | (b & 0x3f);
     }
+    // overlong forms, surrogates and anything past U+10FFFF are invalid too
+    valid = valid && cp >= min && cp <= 0x10ffff && (cp < 0xd800 || cp > 0xdfff);
 
-    if (bitmap_size != expected_bitmap_size) {
-        Asura::Log::get().error("Bitmap size mismatch in cache for font {} at: {} (expected {}, got {})", 
-            font.name, path, expected_bitmap_size, bitmap_size);
-        return false;  // fallback to regenerate
+    i += valid ? len : 1;
+    return valid ? cp : 0xfffd;
+}
+
+/*
+ * Packs the kept glyphs from scratch into a w x h atlas, copying their pixels over from the current bitmap, and drops
+ * the rest. On failure the glyphs and bitmap are left alone but the packer is not, so another repack has to follow.
+ */
+static bool repack(Asura::Font::GlyphAtlas& atlas, const std::vector<uint64_t>& keep, int w, int h) {
+    std::vector<stbrp_rect> rects;
+    std::vector<uint64_t> keys;
+    rects.reserve(keep.size());
+    keys.reserve(keep.size());
+    for (uint64_t key : keep) {
+        const Asura::Font::Glyph& g = atlas.glyphs.at(key);
+        if (g.w == 0 || g.h == 0) continue;
+        stbrp_rect r = {};
+        r.id = static_cast<int>(keys.size());
+        r.w  = g.w + 1;
+        r.h  = g.h + 1;
+        rects.push_back(r);
+        keys.push_back(key);
     }
 
-    font.bitmap.resize(bitmap_size);
-    if (bitmap_size > 0) {
-        in.read(reinterpret_cast<char*>(font.bitmap.data()),
-                bitmap_size);
-        if (!in) {
-            Asura::Log::get().error("Bad read on bitmap for {} from: {}", font.name, path);
-            return false;
+    atlas.nodes.assign(static_cast<size_t>(w), {});
+    stbrp_init_target(&atlas.packer, w, h, atlas.nodes.data(), w);
+    if (!stbrp_pack_rects(&atlas.packer, rects.data(), static_cast<int>(rects.size()))) return false;
+
+    std::vector<std::uint8_t> bitmap(static_cast<size_t>(w) * static_cast<size_t>(h), 0);
+    for (const stbrp_rect& r : rects) {
+        Asura::Font::Glyph& g = atlas.glyphs.at(keys[static_cast<size_t>(r.id)]);
+        for (int row = 0; row < g.h; ++row) {
+            std::memcpy(bitmap.data() + static_cast<size_t>(r.y + row) * w + r.x,
+                        atlas.bitmap.data() + static_cast<size_t>(g.y + row) * atlas.w + g.x, static_cast<size_t>(g.w));
         }
+        g.x = r.x;
+        g.y = r.y;
     }
 
-    // read baked chars
-    in.read(reinterpret_cast<char*>(font.chars.data()), NUM_CHARS * sizeof(stbtt_bakedchar));
-    if (!in) {
-        Asura::Log::get().error("Bad read on baked chars for {} from: {}", font.name, path);
-        return false;
+    const std::unordered_set<uint64_t> kept(keep.begin(), keep.end());
+    std::erase_if(atlas.glyphs, [&kept](const auto& entry) { return !kept.contains(entry.first); });
+
+    atlas.resized |= w != atlas.w || h != atlas.h;
+    atlas.layout++;
+    atlas.dirty = true;
+    atlas.bitmap.swap(bitmap);
+    atlas.w = w;
+    atlas.h = h;
+    return true;
+}
+
+// A side of the glyph atlas, rounded up to whole 16 texel blocks so rows stay aligned on every backend.
+static int atlas_side(int64_t texels) {
+    return static_cast<int>(std::min<int64_t>((texels + 15) & ~int64_t{15}, MAX_GLYPH_ATLAS));
+}
+
+/*
+ * Packs every rect at once into the smallest atlas they fit, starting from a square of their total area and growing the
+ * shorter side an eighth at a time. The packer is left as it is, so glyphs rasterized later go in the space left over.
+ */
+static bool pack_tight(Asura::Font::GlyphAtlas& atlas, std::vector<stbrp_rect>& rects) {
+    int64_t area = 0;
+    int wide = 1, tall = 1;
+    for (const stbrp_rect& r : rects) {
+        area += static_cast<int64_t>(r.w) * r.h;
+        wide = std::max(wide, r.w);
+        tall = std::max(tall, r.h);
+    }
+    int w = atlas_side(std::max<int64_t>(wide, static_cast<int64_t>(std::ceil(std::sqrt(static_cast<double>(area))))));
+    int h = atlas_side(std::max<int64_t>(tall, (area + w - 1) / w));
+
+    while (true) {
+        atlas.nodes.assign(static_cast<size_t>(w), {});
+        stbrp_init_target(&atlas.packer, w, h, atlas.nodes.data(), w);
+        if (stbrp_pack_rects(&atlas.packer, rects.data(), static_cast<int>(rects.size()))) break;
+        if (w >= MAX_GLYPH_ATLAS && h >= MAX_GLYPH_ATLAS) return false;
+        if ((w <= h && w < MAX_GLYPH_ATLAS) || h >= MAX_GLYPH_ATLAS) w = atlas_side(w + w / 8);
+        else h = atlas_side(h + h / 8);
     }
 
+    atlas.bitmap.assign(static_cast<size_t>(w) * static_cast<size_t>(h), 0);
+    atlas.w = w;
+    atlas.h = h;
+    atlas.layout++;
+    atlas.resized = true;
+    atlas.dirty = true;
     return true;
 }
 
-void Asura::Font::Renderer::init(const std::string &fonts_dir, std::vector<ResourceDef> reg) {
+void Asura::Font::Renderer::init(const std::string &fonts_dir, std::vector<ResourceDef> reg, GlyphFormat glyph_format, int glyph_oversample) {
+    format = glyph_format;
+    // distance fields scale smoothly as they are
+    oversample = format == GlyphFormat::SDF ? 1 : std::clamp(glyph_oversample, 1, MAX_OVERSAMPLE);
     id_to_font_index.fill(-1);
     kFontDefs = std::move(reg);
     vs_params.mvp = Utils::Gfx::get_default_projection(Device::instance().high_dpi ? 2 : 1);
     auto res = findPath(fonts_dir);
-    auto path = res.unwrap([fonts_dir]() {
-        Log::get().error("Failed to parse directory at: {}", fonts_dir);
-    });
+    if (res.is_err()) Log::get().error("Failed to parse directory at: {}", fonts_dir);
+    const std::string path = res.is_err() ? fonts_dir : res.unwrap([]() {});
     // LOGSURA_DEBUG("Parsed dir: {}", path);
-    _init_fonts(fonts_dir.c_str());
+    _init_fonts(path.c_str());
     _init_fr();
 }
 
-void Asura::Font::Renderer::render(Math::Mat4 view) {
-    sg_apply_pipeline(pip);
+// A texel edge of the atlas as a USHORT4N component.
+static uint16_t unorm16(int texel, int size) {
+    return static_cast<uint16_t>((static_cast<uint32_t>(texel) * 65535u + static_cast<uint32_t>(size) / 2) / static_cast<uint32_t>(size));
+}
 
-    Math::Mat4 mvp = vs_params.mvp * view;
-    vs_params.mvp = mvp;
+void Asura::Font::Renderer::render(Math::Mat4 view) {
+    // uvs are resolved now, the atlas may have grown or been repacked since the text was pushed
+    _resolve(quads, instances);
+    for (const RetainedDraw& d : retained_draws) _build(retained[d.index]);
 
-    for (auto& f : fonts) {
-        auto& verts = f.batch.verts;
-        auto& indices = f.batch.indices;
+    if (!instances.empty() || !retained_draws.empty()) {
+        _upload();
 
-        if (verts.empty() || indices.empty()) continue;
-        
-        sg_update_buffer(vbuf, SG_VECTOR_RANGE(verts));
+        text_params_t params = vs_params;
+        params.mvp = vs_params.mvp * view;
 
         sg_bindings bind = {};
-        bind.vertex_buffers[0] = vbuf;
+        bind.vertex_buffers[0] = qbuf;
         bind.index_buffer = ibuf;
-        bind.views[VIEW_text_tex] = f.view;
+        bind.views[VIEW_text_tex] = atlas->view;
         bind.samplers[SMP_text_smp] = smp;
 
-        sg_apply_bindings(&bind);
-        sg_apply_uniforms(UB_text_params, SG_RANGE(vs_params));
-        sg_draw(0, static_cast<int>(indices.size()), 1);
+        sg_apply_pipeline(pip);
+
+        // retained text sits in its own buffers, moved into place by the uniforms
+        for (const RetainedDraw& d : retained_draws) {
+            const RetainedText& t = retained[d.index];
+            if (t.count == 0) continue;
+            text_params_t moved = params;
+            moved.mvp = params.mvp * Math::Mat4::translate({d.pos.x, d.pos.y, 0.f});
+
+            bind.vertex_buffers[1] = t.buf;
+            bind.vertex_buffer_offsets[1] = 0;
+            sg_apply_bindings(&bind);
+            sg_apply_uniforms(UB_text_params, SG_RANGE(moved));
+            sg_draw(0, 6, t.count);
+        }
+
+        if (!instances.empty() && _new_frame()) ring = {};
+
+        // one draw unless this frame's text spills into another chunk
+        for (size_t first = 0; first < instances.size();) {
+            if (ring.used == GLYPHS_PER_CHUNK) {
+                ring.chunk++;
+                ring.used = 0;
+            }
+            _grow_chunks(ring.chunk + 1);
+
+            const size_t n = std::min(instances.size() - first, GLYPHS_PER_CHUNK - ring.used);
+            sg_range range = { .ptr = instances.data() + first, .size = n * sizeof(GlyphInstance) };
+            bind.vertex_buffers[1] = chunks[ring.chunk];
+            bind.vertex_buffer_offsets[1] = sg_append_buffer(chunks[ring.chunk], &range);
+
+            sg_apply_bindings(&bind);
+            if (first == 0) sg_apply_uniforms(UB_text_params, SG_RANGE(params));
+            sg_draw(0, 6, static_cast<int>(n));
+
+            ring.used += n;
+            first += n;
+        }
+    }
+
+    if (layouts.size() > MAX_CACHED_LAYOUTS) {
+        std::erase_if(layouts, [this](const auto& entry) { return entry.second.used != frame + 1; });
     }
 
     _clear();
+    ++frame;
 }
 
-void Asura::Font::Renderer::_clear() {
-    for (auto& f : fonts) {
-        f.batch.verts.clear();
-        f.batch.indices.clear();
+void Asura::Font::Renderer::_resolve(const std::vector<GlyphQuad>& in, std::vector<GlyphInstance>& out) const {
+    out.reserve(out.size() + in.size());
+    for (const GlyphQuad& q : in) {
+        auto it = atlas->glyphs.find(q.glyph);
+        if (it == atlas->glyphs.end()) continue;
+        const Glyph& g = it->second;
+        out.push_back(GlyphInstance {
+            q.x0, q.y0, q.x1 - q.x0, q.y1 - q.y0,
+            unorm16(g.x, atlas->w), unorm16(g.y, atlas->h), unorm16(g.x + g.w, atlas->w), unorm16(g.y + g.h, atlas->h),
+            q.color
+        });
+    }
+}
+
+// Whether this is the first render() since the last frame ended; sokol rewinds the append cursors with every frame.
+bool Asura::Font::Renderer::_new_frame() {
+    const uint64_t now = Device::instance().frame;
+    if (drawn_frame == now) return false;
+    drawn_frame = now;
+    return true;
+}
+
+void Asura::Font::Renderer::_grow_chunks(size_t count) {
+    while (chunks.size() < count) {
+        sg_buffer_desc vb = {};
+        vb.size = GLYPHS_PER_CHUNK * sizeof(GlyphInstance);
+        vb.usage.stream_update = true;
+        vb.usage.vertex_buffer = true;
+        vb.label = "glyph-buffer";
+        chunks.push_back(sg_make_buffer(&vb));
+        LOGSURA_DEBUG("Allocated glyph instance chunk #{}", chunks.size());
     }
 }
 
+void Asura::Font::Renderer::_clear() {
+    quads.clear();
+    instances.clear();
+    retained_draws.clear();
+}
+
 void Asura::Font::Renderer::_init_fonts(const char* dir) {
     fonts.clear();
     fonts.reserve(kFontDefs.size());
     id_to_font_index.fill(-1);
 
-    const std::string json_path = findPath(join_path_json(dir, "fonts")).unwrap([dir](){
-        Log::get().error("Failed to parse directory at: {}", dir);
-    });
-    const std::string expected_hash = std::to_string(compute_resource_hash(kFontDefs));
-
-    ordered_json meta;
-    bool meta_valid = false;
-    bool rewrite_json = false;
-
-    if (std::filesystem::exists(json_path)) {
-        json disk;
-        if (read_json_file(json_path, disk)) {
-            try {
-                int first_char   = disk.at("first_char").get<int>();
-                int num_chars    = disk.at("num_chars").get<int>();
-                std::string hash = disk.at("names_hash").get<std::string>();
-
-                if (first_char == FIRST_CHAR &&
-                    num_chars == NUM_CHARS &&
-                    hash == expected_hash &&
-                    disk.contains("fonts") &&
-                    disk["fonts"].is_object()) {
-
-                    meta = disk;
-                    meta_valid = true;
-                } else {
-                    LOGSURA_DEBUG("Font metadata header changed, will rebuild fonts.json");
-                }
-            } catch (const std::exception& e) {
-                Log::get().error("Error reading font metadata header: {}", e.what());
+    // The TTFs stay loaded, glyphs outside the baked range are rasterized from them on first use. A face registered at
+    // several sizes is read once.
+    struct Face {
+        std::shared_ptr<const std::vector<std::uint8_t>> ttf;
+        uint64_t hash;
+    };
+    std::unordered_map<std::string, Face> faces;
+    std::vector<FontCacheEntry> entries;
+    for (auto& [name, id, pixel_size] : kFontDefs) {
+        const std::string ttf = join_path_ttf(dir, name);
+        Face& face = faces[name];
+        if (!face.ttf) {
+            auto bytes = readFileVec(ttf);
+            if (bytes.empty()) {
+                Log::get().error("Failed to read TTF at: {}", ttf);
+                continue;  // or die()
             }
+            face.hash = fnv1a(bytes.data(), bytes.size());
+            face.ttf  = std::make_shared<const std::vector<std::uint8_t>>(std::move(bytes));
         }
-    }
-
-    if (!meta_valid) {
-        meta["first_char"] = FIRST_CHAR;
-        meta["num_chars"]  = NUM_CHARS;
-        meta["names_hash"] = expected_hash;
-        meta["fonts"]      = ordered_json::object();
-        rewrite_json = true;  // will refill
-    }
 
-    for (auto& [name, id, pixel_size] : kFontDefs) {
         Font font = {};
-        font.id   = id;
-        font.name = name;
-        font.size = pixel_size;
-
-        auto png = findPath(join_path_png(dir, font.name)).unwrap([dir]() {
-            Log::get().error("Failed to parse directory at: {}", dir);
-        });
-        auto ttf = findPath(join_path_ttf(dir, font.name)).unwrap([dir]() {
-            Log::get().error("Failed to parse directory at: {}", dir);
-        });
-        auto bin = findPath(join_path_bin(dir, font.name)).unwrap([dir]() {
-            Log::get().error("Failed to parse directory at: {}", dir);
-        });
-
-        bool have_meta = meta_valid && meta.contains("fonts") && meta["fonts"].contains(font.name);
-
-        bool have_files = std::filesystem::exists(png) && std::filesystem::exists(bin);
+        font.id         = id;
+        font.index      = static_cast<int>(fonts.size());
+        font.name       = name;
+        font.size       = pixel_size;
+        font.ttf        = face.ttf;
+        font.oversample = oversample;
+        if (!stbtt_InitFont(&font.info, font.ttf->data(), stbtt_GetFontOffsetForIndex(font.ttf->data(), 0))) {
+            die("Failed to load font at: " + ttf);
+        }
+        font.scale = stbtt_ScaleForPixelHeight(&font.info, static_cast<float>(font.size));
+        if (id >= 0 && id < static_cast<int>(id_to_font_index.size())) {
+            id_to_font_index[id] = font.index;
+        }
 
-        bool reused = false;
+        FontCacheEntry e = {};
+        e.name_hash  = fnv1a(font.name);
+        e.ttf_hash   = face.hash;
+        e.pixel_size = static_cast<uint32_t>(font.size);
+        e.oversample = static_cast<uint32_t>(font.oversample);
+        entries.push_back(e);
+        fonts.push_back(std::move(font));
+    }
 
-        if (have_meta && have_files) {
-            try {
-                auto& f = meta["fonts"][font.name];
-                std::size_t bitmap_size = f.at("size").get<std::size_t>();
-                font.w = f.at("w").get<int>();
-                font.h = f.at("h").get<int>();
-                font.size = f.value("pixel_size", pixel_size);  // fallback
+    // a font is reused when its name, face, size and oversampling all match what was baked
+    const std::string cache_path = join_path_bin(dir, "fonts");
+    auto cache = std::make_unique<MappedFile>(cache_path);
+    const std::span<const FontCacheEntry> cached = font_cache_entries(*cache, format);
+
+    std::vector<FontBakeView> views(fonts.size());
+    std::vector<size_t> cold;
+    for (const Font& font : fonts) {
+        const FontCacheEntry& e = entries[font.index];
+        const auto hit = std::find_if(cached.begin(), cached.end(), [&e](const FontCacheEntry& c) {
+            return c.name_hash == e.name_hash && c.ttf_hash == e.ttf_hash && c.pixel_size == e.pixel_size && c.oversample == e.oversample;
+        });
+        if (hit == cached.end() || !font_cache_view(*cache, *hit, views[font.index])) cold.push_back(static_cast<size_t>(font.index));
+    }
 
-                if (read_font_cache(font, bin, bitmap_size)) {
-                    reused = true;
-                    // LOGSURA_DEBUG("Reused bitmap font 1m{}0m from cache (enum id={})", name, id);
-                    LOGSURA_INFO("Reused bitmap font {} from cache (enum id={})", name, id);
-                } else {
-                    LOGSURA_WARN("Failed to read cache for font {}, will re-bake", name);
-                }
-            } catch (const std::exception& e) {
-                Log::get().error("JSON error for font {}: {}", name, e.what());
-            }
+    // Each worker bakes the next cold font until none are left. Baking only reads the fonts, the atlas is filled afterwards.
+    std::vector<FontBake> bakes(fonts.size());
+    std::atomic<size_t> next = 0;
+    auto worker = [&]() {
+        for (size_t i = next++; i < cold.size(); i = next++) {
+            bakes[cold[i]] = bake_font(fonts[cold[i]], format);
         }
-
-        if (!reused) {
-            auto ttf_bytes = readFileVec(ttf.c_str());
-            if (ttf_bytes.empty()) {
-                Log::get().error("Failed to read TTF at: {}", ttf);
-                continue;  // or die()
-            }
-            auto* ttf_data = ttf_bytes.data();
-
-            auto [gw, gh] = estimateGlyphCellSize(ttf_data, static_cast<float>(font.size), FIRST_CHAR, NUM_CHARS);
-            auto [atlas_w, atlas_h] = estimateAtlasSize(gw, gh, NUM_CHARS);
-
-            font.w = std::bit_ceil(static_cast<uint32_t>(atlas_w));
-            font.h = std::bit_ceil(static_cast<uint32_t>(atlas_h));
-            font.bitmap.resize(static_cast<size_t>(font.w) * font.h);
-
-            int ret = stbtt_BakeFontBitmap(
-                ttf_data,
-                0,
-                static_cast<float>(font.size),
-                font.bitmap.data(),
-                font.w, font.h,
-                FIRST_CHAR, NUM_CHARS,
-                font.chars.data()
-            );
-            if (ret == 0) {
-                die("Failed to load font at: " + ttf);
+    };
+    const size_t count = std::min<size_t>(cold.size(), std::max(1u, std::thread::hardware_concurrency()));
+    std::vector<std::thread> workers;
+    for (size_t t = 1; t < count; ++t) workers.emplace_back(worker);
+    if (count > 0) worker();
+    for (std::thread& t : workers) t.join();
+    for (size_t i : cold) views[i] = view_of(bakes[i]);
+
+    // Every font shares one atlas. The baked glyphs of all of them are packed together into the smallest one they fit.
+    struct Baked {
+        int font;
+        const CachedGlyph* glyph;
+        const std::uint8_t* pixels;
+    };
+    std::vector<Baked> baked;
+    std::vector<stbrp_rect> rects;
+    for (const Font& font : fonts) {
+        const FontBakeView& bake = views[font.index];
+        size_t offset = 0;
+        for (const CachedGlyph& c : bake.glyphs) {
+            if (c.w > 0 && c.h > 0) {
+                // a texel of padding keeps linear filtering from bleeding in the neighbours
+                stbrp_rect r = {};
+                r.id = static_cast<int>(baked.size());
+                r.w  = c.w + 1;
+                r.h  = c.h + 1;
+                rects.push_back(r);
             }
+            baked.push_back({font.index, &c, bake.pixels.data() + offset});
+            offset += static_cast<size_t>(c.w) * static_cast<size_t>(c.h);
+        }
+    }
 
-            stbi_write_png(png.c_str(), font.w, font.h, 1, font.bitmap.data(), font.w);
-            write_font_cache(font, bin);
+    atlas = std::make_unique<GlyphAtlas>();
+    if (!pack_tight(*atlas, rects)) die(std::format("Baked glyphs of every font don't fit a {}x{} atlas", MAX_GLYPH_ATLAS, MAX_GLYPH_ATLAS));
+
+    std::vector<std::pair<int, int>> placed(baked.size(), {0, 0});
+    for (const stbrp_rect& r : rects) placed[static_cast<size_t>(r.id)] = {r.x, r.y};
+    for (size_t i = 0; i < baked.size(); ++i) {
+        const auto& [index, c, pixels] = baked[i];
+        const Glyph g = {
+            .x = placed[i].first, .y = placed[i].second, .w = c->w, .h = c->h,
+            .xoff = c->xoff, .yoff = c->yoff, .advance = c->advance,
+            .used = 0, .pinned = true, .refs = 0,
+        };
+        for (int row = 0; row < g.h; ++row) {
+            std::memcpy(atlas->bitmap.data() + static_cast<size_t>(g.y + row) * atlas->w + g.x,
+                        pixels + static_cast<size_t>(row) * g.w, static_cast<size_t>(g.w));
+        }
+        atlas->glyphs.emplace(glyph_key(index, c->codepoint), g);
+    }
 
-            meta["fonts"][font.name] = {
-                {"bin", bin},
-                {"png", png},
-                {"w", font.w}, {"h", font.h},
-                {"size", font.bitmap.size()},
-                {"pixel_size", font.size}
-            };
+    // what each font costs in the atlas, one byte a texel, padding included
+    size_t filled = 0;
+    for (const Font& font : fonts) {
+        size_t texels = 0;
+        for (const CachedGlyph& c : views[font.index].glyphs) {
+            if (c.w > 0 && c.h > 0) texels += static_cast<size_t>(c.w + 1) * static_cast<size_t>(c.h + 1);
+        }
+        filled += texels;
+        LOGSURA_INFO("Font {} at {}px: {} baked glyphs in {:.1f} KiB of the glyph atlas", font.name, font.size, views[font.index].glyphs.size(), texels / 1024.0);
+    }
+    const size_t capacity = static_cast<size_t>(atlas->w) * static_cast<size_t>(atlas->h);
+    LOGSURA_INFO("Glyph atlas is {}x{} ({:.1f} KiB), {:.0f}% filled", atlas->w, atlas->h, capacity / 1024.0, 100.0 * filled / capacity);
 
-            rewrite_json = true;
+    for (Font& font : fonts) {
+        const FontBakeView& bake = views[font.index];
 
-            LOGSURA_INFO("Generated bitmap font {} (enum id={})", name, id);
+        font.kerning.assign(NUM_CHARS * NUM_CHARS, 0.f);
+        for (const CachedKern& k : bake.kerning) {
+            font.kerning[(k.first - FIRST_CHAR) * NUM_CHARS + (k.second - FIRST_CHAR)] = k.kern;
         }
-        
-        sg_image_desc img = {};
-        img.width  = font.w;
-        img.height = font.h;
-        img.pixel_format = SG_PIXELFORMAT_R8;
-        img.usage.immutable = true;
-        img.data.mip_levels[0].ptr  = font.bitmap.data();
-        img.data.mip_levels[0].size = font.bitmap.size();
-        font.atlas = sg_make_image(&img);
-
-        sg_view_desc vd = {};
-        vd.texture.image = font.atlas;
-        font.view = sg_make_view(&vd);
 
-        int idx = static_cast<int>(fonts.size());
-        fonts.push_back(std::move(font));
+        for (int c = 0; c < NUM_CHARS; ++c) {
+            auto it = atlas->glyphs.find(glyph_key(font.index, static_cast<uint32_t>(FIRST_CHAR + c)));
+            font.advance[c] = it != atlas->glyphs.end() ? it->second.advance : 0.f;
+        }
 
-        if (id >= 0 && id < static_cast<int>(id_to_font_index.size())) {
-            id_to_font_index[id] = idx;
+        if (std::find(cold.begin(), cold.end(), static_cast<size_t>(font.index)) != cold.end()) {
+            LOGSURA_INFO("Generated {} font {} (enum id={})", format == GlyphFormat::SDF ? "SDF" : "bitmap", font.name, font.id);
+        } else {
+            LOGSURA_INFO("Reused {} font {} from cache (enum id={})", format == GlyphFormat::SDF ? "SDF" : "bitmap", font.name, font.id);
         }
     }
 
-    if (rewrite_json) {
-        write_json_file(json_path, meta);
+    // the atlas image is made and filled by the first render()
+    // The cache is rewritten whole when a font was baked or dropped. Reused bakes are copied out before it is unmapped.
+    if (!cold.empty() || cached.size() != fonts.size()) {
+        std::vector<FontBake> kept(fonts.size());
+        for (const Font& font : fonts) {
+            if (std::find(cold.begin(), cold.end(), static_cast<size_t>(font.index)) != cold.end()) continue;
+            const FontBakeView& v = views[font.index];
+            kept[font.index] = {{v.glyphs.begin(), v.glyphs.end()}, {v.kerning.begin(), v.kerning.end()}, {v.pixels.begin(), v.pixels.end()}};
+            views[font.index] = view_of(kept[font.index]);
+        }
+        cache.reset();
+        write_font_cache(cache_path, format, entries, views);
     }
 }
 
+// Writes the shared glyph atlas as a greyscale PNG, for checking what was baked and packed.
+void Asura::Font::Renderer::write_atlas_png(const std::string& path) const {
+    if (!atlas || atlas->bitmap.empty()) return;
+    if (!stbi_write_png(path.c_str(), atlas->w, atlas->h, 1, atlas->bitmap.data(), atlas->w)) {
+        Log::get().error("Failed to write glyph atlas to: {}", path);
+    }
+}
 
 void Asura::Font::Renderer::_init_fr() {
-    sg_buffer_desc vb = {};
-    vb.size = MAX_GLYPHS * 4 * sizeof(Vertex);
-    vb.usage.stream_update = true;
-    vb.usage.vertex_buffer = true;
-    vbuf = sg_make_buffer(&vb);
-
-    std::vector<uint16_t> tmp;
-    tmp.reserve(MAX_GLYPHS * 6);
-    for (int i = 0; i < MAX_GLYPHS; ++i) {
-        auto base = static_cast<uint16_t>(i * 4);
-        tmp.push_back(base + 0);
-        tmp.push_back(base + 1);
-        tmp.push_back(base + 2);
-        tmp.push_back(base + 0);
-        tmp.push_back(base + 2);
-        tmp.push_back(base + 3);
-    }
+    const float corners[] = { 0.f, 0.f,  1.f, 0.f,  1.f, 1.f,  0.f, 1.f };
+    sg_buffer_desc qb = {};
+    qb.usage.vertex_buffer = true;
+    qb.data = SG_RANGE(corners);
+    qbuf = sg_make_buffer(&qb);
 
+    const uint16_t indices[] = { 0, 1, 2, 0, 2, 3 };
     sg_buffer_desc ib = {};
     ib.usage.index_buffer = true;
-    ib.data.ptr = tmp.data();
-    ib.data.size = tmp.size() * sizeof(uint16_t);
+    ib.data = SG_RANGE(indices);
     ibuf = sg_make_buffer(&ib);
 
+    _grow_chunks(1);
+
+    // distance fields and oversampled glyphs are meant to be interpolated, bitmaps stay sharp when magnified
     sg_sampler_desc sd = {};
     sd.min_filter = SG_FILTER_LINEAR;
-    sd.mag_filter = SG_FILTER_NEAREST;
+    sd.mag_filter = format == GlyphFormat::SDF || oversample > 1 ? SG_FILTER_LINEAR : SG_FILTER_NEAREST;
     smp = sg_make_sampler(&sd);
 
-    sg_shader shd = sg_make_shader(text_shader_desc(sg_query_backend()));
+    sg_shader shd = sg_make_shader(format == GlyphFormat::SDF ? text_sdf_shader_desc(sg_query_backend()) : text_shader_desc(sg_query_backend()));
 
     sg_pipeline_desc pip_desc = {};
-    pip_desc.layout.buffers[0].stride = sizeof(Vertex);
-    
-    pip_desc.layout.attrs[ATTR_text_position].format = SG_VERTEXFORMAT_FLOAT2;
-    pip_desc.layout.attrs[ATTR_text_position].offset = offsetfr(x);
-
-    pip_desc.layout.attrs[ATTR_text_texcoord0].format = SG_VERTEXFORMAT_FLOAT2;
-    pip_desc.layout.attrs[ATTR_text_texcoord0].offset = offsetfr(u);
-
-    pip_desc.layout.attrs[ATTR_text_color0].format = SG_VERTEXFORMAT_FLOAT4;
-    pip_desc.layout.attrs[ATTR_text_color0].offset = offsetfr(color);
+    pip_desc.layout.buffers[0].stride = 2 * sizeof(float);
+    pip_desc.layout.buffers[1].stride = sizeof(GlyphInstance);
+    pip_desc.layout.buffers[1].step_func = SG_VERTEXSTEP_PER_INSTANCE;
+    // attrs follows buffer_idx, offset, format
+    pip_desc.layout.attrs[ATTR_text_corner]  = { 0, 0,               SG_VERTEXFORMAT_FLOAT2, };
+    pip_desc.layout.attrs[ATTR_text_rect]    = { 1, offsetfr(x),     SG_VERTEXFORMAT_FLOAT4, };
+    pip_desc.layout.attrs[ATTR_text_uv_rect] = { 1, offsetfr(u0),    SG_VERTEXFORMAT_USHORT4N, };
+    pip_desc.layout.attrs[ATTR_text_color0]  = { 1, offsetfr(color), SG_VERTEXFORMAT_UBYTE4N, };
 
     pip_desc.colors[0].blend.enabled          = true;
     pip_desc.colors[0].blend.src_factor_rgb   = SG_BLENDFACTOR_SRC_ALPHA;
@@ -387,48 +796,359 @@ Asura::Font::Font* Asura::Font::Renderer::_find_font(int id) {
     return &fonts[idx];
 }
 
-void Asura::Font::Renderer::_push_text(int id, std::string_view text, Math::Vec2 pos, float scale, sg_color tint) {
+void Asura::Font::Renderer::_push_text(int id, std::string_view text, Math::Vec2 pos, float width, float scale, sg_color tint) {
     Font* font = _find_font(id);
     if (!font || text.empty()) return;
-    
-    auto& verts   = font->batch.verts;
-    auto& indices = font->batch.indices;
+    _layout(*font, _shape(*font, text, scale, width), pos, scale, Utils::Gfx::rgba8(tint), quads);
+}
+
+Asura::Math::Vec2 Asura::Font::Renderer::_measure(int id, std::string_view text, float scale, float width) {
+    Font* font = _find_font(id);
+    if (!font || text.empty()) return {0.f, 0.f};
+    return _shape(*font, text, scale, width).size;
+}
+
+static float advance_of(const Asura::Font::Font& font, uint32_t c) {
+    if (c >= FIRST_CHAR && c < FIRST_CHAR + NUM_CHARS) return font.advance[c - FIRST_CHAR];
+    int advance = 0, lsb = 0;
+    stbtt_GetCodepointHMetrics(&font.info, static_cast<int>(c), &advance, &lsb);
+    return advance * font.scale;
+}
 
-    Math::Vec4 col = {tint.r, tint.g, tint.b, tint.a};
+static float kern_of(const Asura::Font::Font& font, uint32_t a, uint32_t b) {
+    const auto baked = [](uint32_t c) { return c >= FIRST_CHAR && c < FIRST_CHAR + NUM_CHARS; };
+    if (baked(a) && baked(b)) return font.kerning[(a - FIRST_CHAR) * NUM_CHARS + (b - FIRST_CHAR)];
+    return stbtt_GetCodepointKernAdvance(&font.info, static_cast<int>(a), static_cast<int>(b)) * font.scale;
+}
 
-    float x = pos.x;
-    float y = pos.y;
+/*
+ * Lays text out into pen positions, or finds it in the layout cache. With a width above 0, lines break at the last
+ * space that keeps them within it, or before the glyph that overflows when a word fills the line by itself.
+ */
+const Asura::Font::TextRun& Asura::Font::Renderer::_shape(const Font& font, std::string_view text, float scale, float width) {
+    const uint64_t key = std::hash<std::string_view>{}(text)
+                       ^ static_cast<uint64_t>(font.index) * 0x9e3779b97f4a7c15ull
+                       ^ (static_cast<uint64_t>(std::bit_cast<uint32_t>(scale)) << 32 | std::bit_cast<uint32_t>(width));
+    TextRun& run = layouts[key];
+    if (run.used != 0 && run.font == font.index && run.scale == scale && run.width == width && run.text == text) {
+        run.used = frame + 1;
+        return run;
+    }
 
-    for (char c : text) {
+    run.pens.clear();
+    run.used  = frame + 1;  // + 1 so a fresh run never looks laid out
+    run.font  = font.index;
+    run.scale = scale;
+    run.width = width;
+    run.text  = text;
+
+    const float limit = width > 0.f ? width / scale : 0.f;  // pens are unscaled
+    const float line_h = static_cast<float>(font.size);
+    float x = 0.f, y = 0.f;
+    float line_end = 0.f, widest = 0.f;  // line_end leaves out trailing spaces
+    size_t line_start = 0;
+    size_t brk = SIZE_MAX;               // first pen after the last space of the line
+    float brk_x = 0.f, brk_end = 0.f;    // where that pen starts, and line_end before the space
+    uint32_t prev = 0;
+
+    const auto new_line = [&]() {
+        widest = std::max(widest, line_end);
+        x = 0.f;
+        y += line_h;
+        line_end = 0.f;
+        line_start = run.pens.size();
+        brk = SIZE_MAX;
+    };
+
+    for (size_t i = 0; i < text.size();) {
+        const uint32_t c = next_codepoint(text, i);
         if (c == '\n') {
-            x = pos.x;
-            y += font->size * scale;
+            new_line();
+            prev = 0;
             continue;
         }
+        if (c < FIRST_CHAR) continue;
+
+        float kern = prev ? kern_of(font, prev, c) : 0.f;
+        const float advance = advance_of(font, c);
+        if (limit > 0.f && c != ' ' && x + kern + advance > limit && run.pens.size() > line_start) {
+            if (brk != SIZE_MAX) {
+                // the word since the last space moves down whole
+                std::vector<TextRun::Pen> word(run.pens.begin() + static_cast<std::ptrdiff_t>(brk), run.pens.end());
+                run.pens.resize(brk);
+                const float word_end = x - brk_x;
+                line_end = brk_end;
+                new_line();
+                for (TextRun::Pen p : word) {
+                    p.x -= brk_x;
+                    p.y = y;
+                    run.pens.push_back(p);
+                }
+                x = word_end;
+                line_end = word_end;
+            } else {
+                new_line();
+                kern = 0.f;
+            }
+        }
 
-        int ci = (int)(unsigned char)c - FIRST_CHAR;
-        if (ci < 0 || ci >= NUM_CHARS) continue;
+        x += kern;
+        run.pens.push_back({c, x, y});
+        x += advance;
+        if (c == ' ') {
+            brk = run.pens.size();
+            brk_x = x;
+            brk_end = line_end;
+        } else {
+            line_end = x;
+        }
+        prev = c;
+    }
+    widest = std::max(widest, line_end);
 
-        stbtt_aligned_quad q;
-        stbtt_GetBakedQuad(font->chars.data(), font->w, font->h, ci, &x, &y, &q, true);
+    run.size = {widest * scale, (y + line_h) * scale};
+    return run;
+}
 
-        float x0 = pos.x + (q.x0 - pos.x) * scale;
-        float y0 = pos.y + (q.y0 - pos.y) * scale;
-        float x1 = pos.x + (q.x1 - pos.x) * scale;
-        float y1 = pos.y + (q.y1 - pos.y) * scale;
+void Asura::Font::Renderer::_layout(Font& font, const TextRun& run, Math::Vec2 pos, float scale, uint32_t color, std::vector<GlyphQuad>& out) {
+    for (const TextRun::Pen& p : run.pens) {
+        const Glyph* g = _glyph(font, p.codepoint);
+        if (!g || g->w == 0) continue;
 
-        auto base = static_cast<std::uint16_t>(verts.size());
+        // bitmaps are rounded to whole pixels like stbtt_GetBakedQuad, distance fields and oversampled glyphs can sit anywhere
+        const bool snap = format == GlyphFormat::Bitmap;
+        const float gx = snap && font.oversample == 1 ? std::floor(pos.x + p.x + g->xoff + 0.5f) : pos.x + p.x + g->xoff;
+        const float gy = snap ? std::floor(pos.y + p.y + g->yoff + 0.5f) : pos.y + p.y + g->yoff;
+        const float gw = static_cast<float>(g->w) / static_cast<float>(font.oversample);
 
-        verts.push_back(Vertex { x0, y0, q.s0, q.t0, col });
-        verts.push_back(Vertex { x1, y0, q.s1, q.t0, col });
-        verts.push_back(Vertex { x1, y1, q.s1, q.t1, col });
-        verts.push_back(Vertex { x0, y1, q.s0, q.t1, col });
+        float x0 = pos.x + (gx - pos.x) * scale;
+        float y0 = pos.y + (gy - pos.y) * scale;
+        float x1 = pos.x + (gx + gw - pos.x) * scale;
+        float y1 = pos.y + (gy + g->h - pos.y) * scale;
 
-        indices.push_back(base + 0);
-        indices.push_back(base + 1);
-        indices.push_back(base + 2);
-        indices.push_back(base + 0);
-        indices.push_back(base + 2);
-        indices.push_back(base + 3);
+        out.push_back(GlyphQuad { x0, y0, x1, y1, glyph_key(font.index, p.codepoint), color });
     }
 }
+
+Asura::Font::TextHandle Asura::Font::Renderer::_retain(int id, std::string_view text, float scale, sg_color tint) {
+    Font* font = _find_font(id);
+    if (!font) return {};
+
+    uint32_t index = static_cast<uint32_t>(retained.size());
+    if (!free_retained.empty()) {
+        index = free_retained.back();
+        free_retained.pop_back();
+    } else {
+        retained.push_back({});
+    }
+
+    RetainedText& t = retained[index];
+    t.font  = id;
+    t.text  = text;
+    t.scale = scale;
+    t.color = Utils::Gfx::rgba8(tint);
+    t.live  = true;
+    _layout(*font, _shape(*font, t.text, t.scale, 0.f), {0.f, 0.f}, t.scale, t.color, t.quads);
+    _ref(t.quads, 1);
+    return {index, t.generation};
+}
+
+Asura::Font::RetainedText* Asura::Font::Renderer::_retained(TextHandle handle) {
+    if (handle.index >= retained.size()) return nullptr;
+    RetainedText& t = retained[handle.index];
+    return t.live && t.generation == handle.generation ? &t : nullptr;
+}
+
+void Asura::Font::Renderer::set_text(TextHandle handle, std::string_view text) {
+    RetainedText* t = _retained(handle);
+    if (!t || t->text == text) return;
+
+    // the new glyphs are looked up before the old ones are let go, so glyphs both strings share stay put
+    std::vector<GlyphQuad> old = std::move(t->quads);
+    t->quads.clear();
+    t->text = text;
+    Font& font = *_find_font(t->font);
+    _layout(font, _shape(font, t->text, t->scale, 0.f), {0.f, 0.f}, t->scale, t->color, t->quads);
+    _ref(t->quads, 1);
+    _ref(old, -1);
+
+    if (t->buf.id != SG_INVALID_ID) sg_destroy_buffer(t->buf);
+    t->buf = {};
+}
+
+void Asura::Font::Renderer::draw(TextHandle handle, Math::Vec2 pos) {
+    if (_retained(handle)) retained_draws.push_back({handle.index, pos});
+}
+
+void Asura::Font::Renderer::release(TextHandle handle) {
+    RetainedText* t = _retained(handle);
+    if (!t) return;
+
+    _ref(t->quads, -1);
+    if (t->buf.id != SG_INVALID_ID) sg_destroy_buffer(t->buf);
+    std::erase_if(retained_draws, [&handle](const RetainedDraw& d) { return d.index == handle.index; });
+
+    const uint32_t generation = t->generation + 1;
+    *t = {};
+    t->generation = generation;
+    free_retained.push_back(handle.index);
+}
+
+void Asura::Font::Renderer::_ref(const std::vector<GlyphQuad>& glyphs, int delta) {
+    for (const GlyphQuad& q : glyphs) {
+        if (auto it = atlas->glyphs.find(q.glyph); it != atlas->glyphs.end()) it->second.refs += delta;
+    }
+}
+
+// Uploads a retained text's instances, again if the atlas was repacked since, as the uvs in them moved.
+void Asura::Font::Renderer::_build(RetainedText& text) {
+    if (text.buf.id != SG_INVALID_ID && text.layout == atlas->layout) return;
+    if (text.buf.id != SG_INVALID_ID) sg_destroy_buffer(text.buf);
+    text.buf = {};
+    text.layout = atlas->layout;
+
+    std::vector<GlyphInstance> built;
+    _resolve(text.quads, built);
+    text.count = static_cast<int>(built.size());
+    if (built.empty()) return;
+
+    sg_buffer_desc vb = {};
+    vb.usage.vertex_buffer = true;
+    vb.data = { built.data(), built.size() * sizeof(GlyphInstance) };
+    vb.label = "retained-text";
+    text.buf = sg_make_buffer(&vb);
+}
+
+const Asura::Font::Glyph* Asura::Font::Renderer::_glyph(Font& font, uint32_t codepoint, bool pinned) {
+    if (auto it = atlas->glyphs.find(glyph_key(font.index, codepoint)); it != atlas->glyphs.end()) {
+        it->second.used = frame;
+        return &it->second;
+    }
+
+    Glyph g = {};
+    g.used = frame;
+    g.pinned = pinned;
+    unsigned char* pixels = rasterize(font, format, codepoint, g);
+    const Glyph* placed = _place(font, codepoint, g, pixels);
+    free_glyph(pixels, format);
+    return placed;
+}
+
+// Packs a rasterized glyph into the atlas, making room if needed, and copies its w x h pixels in.
+const Asura::Font::Glyph* Asura::Font::Renderer::_place(const Font& font, uint32_t codepoint, Glyph g, const std::uint8_t* pixels) {
+    if (g.w > 0 && g.h > 0) {
+        // a texel of padding keeps linear filtering from bleeding in the neighbours
+        stbrp_rect r = {};
+        r.w = g.w + 1;
+        r.h = g.h + 1;
+        while (!stbrp_pack_rects(&atlas->packer, &r, 1)) {
+            if (!_make_room()) {
+                LOGSURA_WARN("No room for glyph U+{:04X} of {} in the glyph atlas, it is skipped this frame", codepoint, font.name);
+                return nullptr;
+            }
+        }
+        g.x = r.x;
+        g.y = r.y;
+        for (int row = 0; row < g.h; ++row) {
+            std::memcpy(atlas->bitmap.data() + static_cast<size_t>(g.y + row) * atlas->w + g.x,
+                        pixels + static_cast<size_t>(row) * g.w, static_cast<size_t>(g.w));
+        }
+        atlas->dirty = true;
+    }
+    return &atlas->glyphs.emplace(glyph_key(font.index, codepoint), g).first->second;
+}
+
+bool Asura::Font::Renderer::_make_room() {
+    auto& a = *atlas;
+    std::vector<uint64_t> keep;
+    keep.reserve(a.glyphs.size());
+
+    // Grow the shorter side while the atlas is below its limit, so it stays small while little text is drawn.
+    bool failed = false;
+    if (a.w < MAX_GLYPH_ATLAS || a.h < MAX_GLYPH_ATLAS) {
+        for (const auto& entry : a.glyphs) keep.push_back(entry.first);
+        const bool wider = a.w <= a.h && a.w < MAX_GLYPH_ATLAS;
+        const int w = wider ? std::min(a.w * 2, MAX_GLYPH_ATLAS) : a.w;
+        const int h = wider ? a.h : std::min(a.h * 2, MAX_GLYPH_ATLAS);
+        if (repack(a, keep, w, h)) {
+            LOGSURA_DEBUG("Grew glyph atlas to {}x{}", w, h);
+            return true;
+        }
+        failed = true;
+        keep.clear();
+    }
+
+    /*
+     * Full: drop the least recently used glyphs until the rest covers at most half the atlas, so the next few misses
+     * don't evict again. Baked glyphs, glyphs of retained text and glyphs pushed this frame stay, as they still have
+     * to be drawn.
+     */
+    std::vector<std::pair<uint64_t, uint64_t>> candidates;
+    size_t area = 0;
+    for (const auto& [key, g] : a.glyphs) {
+        area += static_cast<size_t>(g.w + 1) * static_cast<size_t>(g.h + 1);
+        if (g.pinned || g.refs > 0 || g.used == frame) keep.push_back(key);
+        else candidates.push_back({g.used, key});
+    }
+    std::sort(candidates.begin(), candidates.end());
+
+    const size_t budget = static_cast<size_t>(a.w) * static_cast<size_t>(a.h) / 2;
+    size_t dropped = 0;
+    for (const auto& [used, key] : candidates) {
+        const Glyph& g = a.glyphs.at(key);
+        if (area > budget) {
+            area -= static_cast<size_t>(g.w + 1) * static_cast<size_t>(g.h + 1);
+            ++dropped;
+        } else {
+            keep.push_back(key);
+        }
+    }
+    if (dropped == 0 && !failed) return false;
+
+    if (!repack(a, keep, a.w, a.h)) {
+        // what can't be evicted has to fit on its own, so this only fails when retained text fills the atlas
+        std::erase_if(keep, [&a](uint64_t key) { const Glyph& g = a.glyphs.at(key); return !g.pinned && g.refs == 0; });
+        if (!repack(a, keep, a.w, a.h)) die("Failed to repack glyph atlas, too much retained text");
+    }
+    a.evictions += static_cast<int>(dropped);
+    LOGSURA_DEBUG("Evicted {} glyph(s) from the glyph atlas, {} left", dropped, a.glyphs.size());
+    return true;
+}
+
+void Asura::Font::Renderer::_upload() {
+    auto& a = *atlas;
+    if (!a.dirty) return;
+
+    /*
+     * Sokol takes one update per image per frame, so glyphs rasterized or moved after this frame's upload go into a
+     * fresh image, as a grown atlas does. Draws issued earlier in the frame keep the image they were bound with.
+     */
+    const uint64_t stamp = Device::instance().frame + 1;  // + 1 so a fresh atlas never looks uploaded
+    if (a.uploaded == stamp) a.resized = true;
+
+    // dynamic images can't change size, so a grown atlas gets a new image
+    if (a.resized) {
+        if (a.image.id != SG_INVALID_ID) {
+            sg_destroy_view(a.view);
+            sg_destroy_image(a.image);
+        }
+        sg_image_desc img = {};
+        img.width  = a.w;
+        img.height = a.h;
+        img.pixel_format = SG_PIXELFORMAT_R8;
+        img.usage.dynamic_update = true;
+        a.image = sg_make_image(&img);
+
+        sg_view_desc vd = {};
+        vd.texture.image = a.image;
+        a.view = sg_make_view(&vd);
+        a.resized = false;
+    }
+
+    sg_image_data data = {};
+    data.mip_levels[0].ptr  = a.bitmap.data();
+    data.mip_levels[0].size = a.bitmap.size();
+    sg_update_image(a.image, &data);
+    a.dirty = false;
+    a.uploaded = stamp;
+}
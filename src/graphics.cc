@@ -62,6 +62,11 @@ void Asura::init(const Device& device) {
     LOGSURA_INFO("Window Backend: {}", win_backend);
     LOGSURA_INFO("Graphics Backend: {}", gfx_backend);
 
+    // shader.glsl.h only carries GLSL until it is regenerated with sokol-shdc, see the asura_shaders target
+    if (sg_query_backend() != SG_BACKEND_GLCORE) {
+        Utils::die(std::format("shader.glsl.h has no {} shaders, regenerate it with sokol-shdc", gfx_backend));
+    }
+
     if (device.debug) {
         LOGSURA_DEBUG("Enabled gfx debugging at {}px", device.debug_scale);
 
@@ -80,6 +85,8 @@ void Asura::init(const Device& device) {
 
         sdtx_canvas(cx, cy);
         sdtx_origin(1.f, 1.f);
+
+        Debug::init_primitives();
     }
 }
 
@@ -100,9 +107,13 @@ void Asura::begin(sg_pass pass) {
 }
 
 void Asura::end() {
-    if (Device::instance().debug) sdtx_draw();
+    if (Device::instance().debug) {
+        Debug::draw_primitives();
+        sdtx_draw();
+    }
     sg_end_pass();
     sg_commit();
+    ++Device::instance().frame;
 }
 
 std::string Asura::get_backend() {
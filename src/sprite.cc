@@ -11,6 +11,12 @@
 #include <stb_image_write.h>
 #include <stb_rect_pack.h>
 
+#include <atomic>
+#include <chrono>
+#include <set>
+#include <unordered_map>
+#include <thread>
+
 #include <nlohmann/json.hpp>
 using namespace nlohmann;
 
@@ -19,7 +25,8 @@ using namespace nlohmann;
 using namespace Asura::Utils;
 using namespace Asura::Utils::System;
 
-#define offsetir(v) (int)offsetof(InstanceData, v)
+#define offsetir(v)  (int)offsetof(InstanceData, v)
+#define offsetcir(v) (int)offsetof(CompactInstanceData, v)
 
 inline static sg_buffer make_unit_vbuf() {
     const float vertices[] = {
@@ -45,85 +52,517 @@ inline static sg_buffer make_ibuf() {
     return sg_make_buffer(&ibuf_desc);
 }
 
-void Asura::Sprite::Renderer::init(const std::string &images_dir, std::vector<Asura::ResourceDef> reg) {
+void Asura::Sprite::Renderer::init(const std::string &images_dir, std::vector<Asura::ResourceDef> reg, InstanceLayout layout, AtlasFormat format) {
     kSpriteDefs = reg;
-    ir.vs_params.mvp = Utils::Gfx::get_default_projection(Device::instance().high_dpi ? 2 : 1);
+    ir.layout = layout;
+    ir.format = format;
+    ir.stride = layout == InstanceLayout::Compact ? sizeof(CompactInstanceData) : sizeof(InstanceData);
+    ir.projection = Utils::Gfx::get_default_projection(Device::instance().high_dpi ? 2 : 1);
     auto res = findPath(images_dir);
     auto path = res.unwrap([images_dir]() {
         LOGSURA_ERROR("Failed to parse directory at: {}", images_dir);
     });
     // LOGSURA_DEBUG("Parsed dir: {}", path);
     _init_images(path.c_str());
-    _init_ir(atlas.path);
+    _init_ir();
 }
 
 void Asura::Sprite::Renderer::render(Math::Mat4 view) {
-    _update_ir(ir.vs_params.mvp, view);
+    _update_ir(view);
     _draw_ir();
     _clear();
 }
 
+// A sprite's footprint in the atlas, gutter included.
+typedef struct {
+    int page;
+    int x, y, w, h;
+} AtlasRect;
+
+static AtlasRect footprint(int page, int x, int y, int w, int h) {
+    return {page, x - ATLAS_GUTTER, y - ATLAS_GUTTER, w + 2 * ATLAS_GUTTER, h + 2 * ATLAS_GUTTER};
+}
+
+static AtlasRect footprint(const Asura::Sprite::Sprite& tex) {
+    return footprint(tex.page, tex.x, tex.y, tex.trim_w, tex.trim_h);
+}
+
+// A page holds its mip levels back to back, level 0 first, each half the size of the one before down to 1x1.
+static int mip_count(int w, int h) {
+    return std::bit_width(static_cast<unsigned>(std::max(w, h)));
+}
+
+static size_t mip_offset(int w, int h, int level) {
+    size_t offset = 0;
+    for (int l = 0; l < level; ++l) offset += static_cast<size_t>(std::max(1, w >> l)) * static_cast<size_t>(std::max(1, h >> l)) * 4;
+    return offset;
+}
+
+static size_t chain_bytes(int w, int h) {
+    return mip_offset(w, h, mip_count(w, h));
+}
+
+// Each 2x2 block becomes one texel, with colour weighted by alpha so transparent texels don't darken sprite edges.
+static void downsample(const unsigned char* src, int sw, int sh, unsigned char* dst, int dw, int dh) {
+    for (int y = 0; y < dh; ++y) {
+        const unsigned char* r0 = src + static_cast<size_t>(std::min(2 * y, sh - 1)) * static_cast<size_t>(sw) * 4;
+        const unsigned char* r1 = src + static_cast<size_t>(std::min(2 * y + 1, sh - 1)) * static_cast<size_t>(sw) * 4;
+        unsigned char* out = dst + static_cast<size_t>(y) * static_cast<size_t>(dw) * 4;
+        for (int x = 0; x < dw; ++x) {
+            const int x0 = std::min(2 * x, sw - 1) * 4;
+            const int x1 = std::min(2 * x + 1, sw - 1) * 4;
+            const uint32_t a = r0[x0 + 3] + r0[x1 + 3] + r1[x0 + 3] + r1[x1 + 3];
+            const float inv = 1.f / static_cast<float>(std::max(a, 1u));
+            for (int c = 0; c < 3; ++c) {
+                const uint32_t sum = r0[x0 + c] * r0[x0 + 3] + r0[x1 + c] * r0[x1 + 3] + r1[x0 + c] * r1[x0 + 3] + r1[x1 + c] * r1[x1 + 3];
+                out[x * 4 + c] = static_cast<unsigned char>(static_cast<float>(sum) * inv + 0.5f);
+            }
+            out[x * 4 + 3] = static_cast<unsigned char>((a + 2) / 4);
+        }
+    }
+}
+
+// Indexed pages are a single level of one byte texels, averaging palette indices would give nonsense colours.
+static int page_levels(const Asura::Sprite::SpriteAtlas& atlas) {
+    return atlas.format == Asura::Sprite::AtlasFormat::Indexed ? 1 : mip_count(atlas.width, atlas.height);
+}
+
+static int texel_bytes(const Asura::Sprite::SpriteAtlas& atlas) {
+    return atlas.format == Asura::Sprite::AtlasFormat::Indexed ? 1 : 4;
+}
+
+static size_t page_bytes(const Asura::Sprite::SpriteAtlas& atlas) {
+    if (atlas.format == Asura::Sprite::AtlasFormat::Indexed) return static_cast<size_t>(atlas.width) * static_cast<size_t>(atlas.height);
+    return chain_bytes(atlas.width, atlas.height);
+}
+
+static void generate_mips(std::vector<unsigned char>& page, const Asura::Sprite::SpriteAtlas& atlas) {
+    const int w = atlas.width, h = atlas.height;
+    for (int level = 1; level < page_levels(atlas); ++level) {
+        downsample(page.data() + mip_offset(w, h, level - 1), std::max(1, w >> (level - 1)), std::max(1, h >> (level - 1)),
+                   page.data() + mip_offset(w, h, level), std::max(1, w >> level), std::max(1, h >> level));
+    }
+}
+
+/*
+ * atlas.bin: this header followed by every page, either raw RGBA8 with its mip chain or one level of palette indices.
+ * Pages start on 64 byte boundaries and need no decoding, so they can be read (or mapped) straight into sg_make_image.
+ */
+typedef struct {
+    char magic[4];        // "ASAT"
+    uint32_t version;
+    uint32_t width, height;
+    uint32_t pages;
+    uint32_t format;      // AtlasFormat, 0 = raw RGBA8, 1 = palette indices
+    uint64_t page_bytes;  // distance between pages
+    uint32_t mip_levels;
+    uint8_t pad[28];
+} AtlasCacheHeader;
+
+static_assert(sizeof(AtlasCacheHeader) == 64);
+
+static constexpr uint32_t ATLAS_CACHE_VERSION = 2;
+
+static uint64_t page_stride(const Asura::Sprite::SpriteAtlas& atlas) {
+    return (page_bytes(atlas) + 63) & ~uint64_t{63};
+}
+
+static void write_atlas_cache(const Asura::Sprite::SpriteAtlas& atlas) {
+    std::ofstream out(atlas.cache, std::ios::binary);
+    if (!out) die(std::format("Failed to open atlas cache for writing: {}", atlas.cache));
+
+    AtlasCacheHeader header = {};
+    std::memcpy(header.magic, "ASAT", 4);
+    header.version    = ATLAS_CACHE_VERSION;
+    header.width      = static_cast<uint32_t>(atlas.width);
+    header.height     = static_cast<uint32_t>(atlas.height);
+    header.pages      = static_cast<uint32_t>(atlas.pixels.size());
+    header.format     = std::to_underlying(atlas.format);
+    header.page_bytes = page_stride(atlas);
+    header.mip_levels = static_cast<uint32_t>(page_levels(atlas));
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    const std::vector<char> padding(header.page_bytes - page_bytes(atlas), 0);
+    for (const auto& page : atlas.pixels) {
+        out.write(reinterpret_cast<const char*>(page.data()), static_cast<std::streamsize>(page.size()));
+        out.write(padding.data(), static_cast<std::streamsize>(padding.size()));
+    }
+    if (!out) die(std::format("Failed to write atlas cache: {}", atlas.cache));
+}
+
+// Fills atlas.pixels from the cache, which has to match the size, format and page count the metadata promised.
+static bool read_atlas_cache(Asura::Sprite::SpriteAtlas& atlas) {
+    std::ifstream in(atlas.cache, std::ios::binary);
+    if (!in) return false;
+
+    AtlasCacheHeader header = {};
+    in.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (!in || std::memcmp(header.magic, "ASAT", 4) != 0 || header.version != ATLAS_CACHE_VERSION ||
+        header.format != std::to_underlying(atlas.format) ||
+        header.width != static_cast<uint32_t>(atlas.width) || header.height != static_cast<uint32_t>(atlas.height) ||
+        header.pages != static_cast<uint32_t>(atlas.page_count) || header.page_bytes != page_stride(atlas) ||
+        header.mip_levels != static_cast<uint32_t>(page_levels(atlas))) {
+        LOGSURA_WARN("Atlas cache at {} does not match its metadata", atlas.cache);
+        return false;
+    }
+
+    const size_t bytes = page_bytes(atlas);
+    atlas.pixels.resize(header.pages);
+    for (size_t p = 0; p < atlas.pixels.size(); ++p) {
+        auto& page = atlas.pixels[p];
+        page.resize(bytes);
+        in.seekg(static_cast<std::streamoff>(sizeof(AtlasCacheHeader) + p * header.page_bytes));
+        in.read(reinterpret_cast<char*>(page.data()), static_cast<std::streamsize>(bytes));
+        if (!in) {
+            atlas.pixels.clear();
+            LOGSURA_WARN("Atlas cache at {} is truncated", atlas.cache);
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+ * Rewrites only the given level 0 rects of an existing cache, rows in place. The mip levels of the pages they touch
+ * are rewritten whole, they're a third of a page at most.
+ */
+static void patch_atlas_cache(const Asura::Sprite::SpriteAtlas& atlas, const std::vector<AtlasRect>& rects) {
+    std::fstream io(atlas.cache, std::ios::in | std::ios::out | std::ios::binary);
+    if (!io) {
+        write_atlas_cache(atlas);
+        return;
+    }
+
+    const uint64_t stride = page_stride(atlas);
+    const int bpp = texel_bytes(atlas);
+    std::set<int> pages;
+    for (const AtlasRect& r : rects) {
+        const auto& page = atlas.pixels[r.page];
+        for (int row = 0; row < r.h; ++row) {
+            const uint64_t at = (static_cast<uint64_t>(r.y + row) * static_cast<uint64_t>(atlas.width) + static_cast<uint64_t>(r.x)) * bpp;
+            io.seekp(static_cast<std::streamoff>(sizeof(AtlasCacheHeader) + r.page * stride + at));
+            io.write(reinterpret_cast<const char*>(page.data() + at), static_cast<std::streamsize>(r.w) * bpp);
+        }
+        pages.insert(r.page);
+    }
+
+    const size_t mips = mip_offset(atlas.width, atlas.height, 1);
+    if (page_levels(atlas) == 1) pages.clear();
+    for (int p : pages) {
+        const auto& page = atlas.pixels[p];
+        io.seekp(static_cast<std::streamoff>(sizeof(AtlasCacheHeader) + p * stride + mips));
+        io.write(reinterpret_cast<const char*>(page.data() + mips), static_cast<std::streamsize>(page.size() - mips));
+    }
+    if (!io) die(std::format("Failed to update atlas cache: {}", atlas.cache));
+}
+
+// Copies a sprite into its rect and repeats its edge pixels out across the gutter. Texels are bpp bytes, as in tex.data.
+static void blit(std::vector<unsigned char>& page, int page_width, int bpp, const Asura::Sprite::Sprite& tex) {
+    const size_t row_bytes = static_cast<size_t>(tex.trim_w) * bpp;
+    for (int row = -ATLAS_GUTTER; row < tex.trim_h + ATLAS_GUTTER; ++row) {
+        const unsigned char* src_row = tex.data + static_cast<size_t>(std::clamp(row, 0, tex.trim_h - 1)) * row_bytes;
+        unsigned char* dest_row = page.data() +
+           (static_cast<size_t>(tex.y + row) * static_cast<size_t>(page_width) + static_cast<size_t>(tex.x)) * bpp;
+        std::memcpy(dest_row, src_row, row_bytes);
+        for (int g = 1; g <= ATLAS_GUTTER; ++g) {
+            std::memcpy(dest_row - g * bpp, src_row, bpp);
+            std::memcpy(dest_row + row_bytes + (g - 1) * bpp, src_row + row_bytes - bpp, bpp);
+        }
+    }
+}
+
+static void clear(std::vector<unsigned char>& page, int page_width, int bpp, const AtlasRect& r) {
+    for (int row = 0; row < r.h; ++row) {
+        unsigned char* dest_row = page.data() +
+           (static_cast<size_t>(r.y + row) * static_cast<size_t>(page_width) + static_cast<size_t>(r.x)) * bpp;
+        std::memset(dest_row, 0, static_cast<size_t>(r.w) * bpp);
+    }
+}
+
+/*
+ * Palette of an indexed atlas. Index 0 is every fully transparent texel, other colours take the next free index in
+ * the order they are met, so adding colours later never moves the ones already in use.
+ */
+typedef std::unordered_map<uint32_t, uint8_t> PaletteLookup;
+
+static PaletteLookup palette_lookup(const std::vector<uint32_t>& palette) {
+    PaletteLookup lookup;
+    for (size_t i = 1; i < palette.size(); ++i) lookup.emplace(palette[i], static_cast<uint8_t>(i));
+    return lookup;
+}
+
+static uint32_t texel(const unsigned char* rgba) {
+    uint32_t c;
+    std::memcpy(&c, rgba, 4);
+    return (c >> 24) == 0 ? 0 : c;
+}
+
+// Adds the colours of a decoded sprite to the palette, false if they don't fit in 256 entries.
+static bool gather_colours(std::vector<uint32_t>& palette, PaletteLookup& lookup, const Asura::Sprite::Sprite& tex) {
+    const size_t count = static_cast<size_t>(tex.trim_w) * static_cast<size_t>(tex.trim_h);
+    uint32_t last = 0;
+    for (size_t i = 0; i < count; ++i) {
+        const uint32_t c = texel(tex.data + i * 4);
+        if (c == 0 || c == last) continue;
+        last = c;
+        if (lookup.contains(c)) continue;
+        if (palette.size() == 256) return false;
+        lookup.emplace(c, static_cast<uint8_t>(palette.size()));
+        palette.push_back(c);
+    }
+    return true;
+}
+
+// Rewrites a decoded sprite's pixels as palette indices, in place; every colour has to be in the lookup.
+static void to_indices(Asura::Sprite::Sprite& tex, const PaletteLookup& lookup) {
+    const size_t count = static_cast<size_t>(tex.trim_w) * static_cast<size_t>(tex.trim_h);
+    for (size_t i = 0; i < count; ++i) {
+        const uint32_t c = texel(tex.data + i * 4);
+        tex.data[i] = c == 0 ? 0 : lookup.at(c);
+    }
+}
+
+/*
+ * First free spot for a w x h rect on a page, scanning top to bottom then left to right. The page is tracked as a grid
+ * of FREE_CELL sized cells (used rects rounded outwards) with a summed area table, so each candidate is an O(1) test.
+ */
+static constexpr int FREE_CELL = 8;
+
+static bool find_free_rect(const std::vector<AtlasRect>& used, int page, int aw, int ah, int w, int h, int& x, int& y) {
+    const int cols = aw / FREE_CELL, rows = ah / FREE_CELL;
+    const int cw = (w + FREE_CELL - 1) / FREE_CELL, ch = (h + FREE_CELL - 1) / FREE_CELL;
+    if (cw > cols || ch > rows) return false;
+
+    const size_t pitch = static_cast<size_t>(cols) + 1;
+    std::vector<uint32_t> sat(pitch * (static_cast<size_t>(rows) + 1), 0);
+    for (const AtlasRect& r : used) {
+        if (r.page != page) continue;
+        const int x1 = std::min(cols, (r.x + r.w + FREE_CELL - 1) / FREE_CELL);
+        const int y1 = std::min(rows, (r.y + r.h + FREE_CELL - 1) / FREE_CELL);
+        for (int cy = r.y / FREE_CELL; cy < y1; ++cy)
+            for (int cx = r.x / FREE_CELL; cx < x1; ++cx) sat[(cy + 1) * pitch + cx + 1] = 1;
+    }
+    for (int cy = 1; cy <= rows; ++cy)
+        for (int cx = 1; cx <= cols; ++cx)
+            sat[cy * pitch + cx] += sat[(cy - 1) * pitch + cx] + sat[cy * pitch + cx - 1] - sat[(cy - 1) * pitch + cx - 1];
+
+    for (int cy = 0; cy + ch <= rows; ++cy) {
+        for (int cx = 0; cx + cw <= cols; ++cx) {
+            const uint32_t sum = sat[(cy + ch) * pitch + cx + cw] - sat[cy * pitch + cx + cw]
+                               - sat[(cy + ch) * pitch + cx] + sat[cy * pitch + cx];
+            if (sum != 0) continue;
+            x = cx * FREE_CELL;
+            y = cy * FREE_CELL;
+            return true;
+        }
+    }
+    return false;
+}
+
+static ordered_json sprite_entry(const Asura::Sprite::Sprite& tex) {
+    return {
+        {"x", tex.x}, {"y", tex.y},
+        {"w", tex.width}, {"h", tex.height},
+        {"tx", tex.trim_x}, {"ty", tex.trim_y}, {"tw", tex.trim_w}, {"th", tex.trim_h},
+        {"page", tex.page},
+        {"size", tex.fingerprint.size}, {"mtime", tex.fingerprint.mtime}, {"hash", tex.fingerprint.hash}
+    };
+}
+
+typedef struct {
+    int width, height;
+    int heuristic;
+} AtlasLayout;
+
+/*
+ * Smallest power of two page that holds every rect. Candidates start at the area lower bound and grow, squarer
+ * first on ties, and each is tried with both stb_rect_pack heuristics. If nothing up to MAX_ATLAS_SIZE fits, pages
+ * are MAX_ATLAS_SIZE and the rest spills into more of them.
+ */
+static AtlasLayout choose_atlas_layout(const std::vector<stbrp_rect>& rects) {
+    uint64_t area = 0;
+    int max_w = 1, max_h = 1;
+    for (const stbrp_rect& r : rects) {
+        area += static_cast<uint64_t>(r.w) * static_cast<uint64_t>(r.h);
+        max_w = std::max(max_w, static_cast<int>(r.w));
+        max_h = std::max(max_h, static_cast<int>(r.h));
+    }
+
+    std::vector<AtlasLayout> candidates;
+    for (int w = std::bit_ceil(static_cast<unsigned>(max_w)); w <= MAX_ATLAS_SIZE; w *= 2) {
+        for (int h = std::bit_ceil(static_cast<unsigned>(max_h)); h <= MAX_ATLAS_SIZE; h *= 2) {
+            if (static_cast<uint64_t>(w) * static_cast<uint64_t>(h) >= area) candidates.push_back({w, h, 0});
+        }
+    }
+    std::sort(candidates.begin(), candidates.end(), [](const AtlasLayout& a, const AtlasLayout& b) {
+        const uint64_t area_a = static_cast<uint64_t>(a.width) * static_cast<uint64_t>(a.height);
+        const uint64_t area_b = static_cast<uint64_t>(b.width) * static_cast<uint64_t>(b.height);
+        if (area_a != area_b) return area_a < area_b;
+        const int skew_a = std::abs(std::countr_zero(static_cast<unsigned>(a.width)) - std::countr_zero(static_cast<unsigned>(a.height)));
+        const int skew_b = std::abs(std::countr_zero(static_cast<unsigned>(b.width)) - std::countr_zero(static_cast<unsigned>(b.height)));
+        if (skew_a != skew_b) return skew_a < skew_b;
+        return a.width > b.width;
+    });
+
+    const int heuristics[] = { STBRP_HEURISTIC_Skyline_BL_sortHeight, STBRP_HEURISTIC_Skyline_BF_sortHeight };
+    std::vector<stbrp_node> nodes(MAX_ATLAS_SIZE);
+    std::vector<stbrp_rect> scratch;
+    for (const AtlasLayout& c : candidates) {
+        for (int heuristic : heuristics) {
+            scratch = rects;
+            stbrp_context ctx;
+            stbrp_init_target(&ctx, c.width, c.height, nodes.data(), c.width);
+            stbrp_setup_heuristic(&ctx, heuristic);
+            if (stbrp_pack_rects(&ctx, scratch.data(), static_cast<int>(scratch.size()))) return {c.width, c.height, heuristic};
+        }
+    }
+    return {MAX_ATLAS_SIZE, MAX_ATLAS_SIZE, STBRP_HEURISTIC_Skyline_BF_sortHeight};
+}
+
+static uint64_t fnv1a(const unsigned char* bytes, size_t size) {
+    uint64_t h = 1469598103934665603ull;
+    for (size_t i = 0; i < size; ++i) { h ^= bytes[i]; h *= 1099511628211ull; }
+    return h;
+}
+
 void Asura::Sprite::Renderer::_pack(const PackDef& def) {
-    int sizeX = def.sizeX;
-    int sizeY = def.sizeY;
-    std::vector<stbrp_rect> rects = def.rects;
     const std::string& out_dir = def.out_dir;
     int rect_count = def.rect_count;
-    int awidth     = def.awidth;
-    int aheight    = def.aheight;
 
-    atlas.width  = awidth  >= 8192 ? 8192 : awidth;
-    atlas.height = aheight >= 8192 ? 8192 : aheight;
-    
-    stbrp_context ctx;
-    std::vector<stbrp_node> nodes(static_cast<size_t>(atlas.width));
-    stbrp_init_target(&ctx, atlas.width, atlas.height, nodes.data(), atlas.width);
+    const auto start = std::chrono::steady_clock::now();
 
-    int ok = stbrp_pack_rects(&ctx, rects.data(), rect_count);
-    if (!ok) { die("Failed to pack all rects"); }
+    // Sprites whose trimmed pixels are identical share one rect; the first of them is packed, the rest alias it.
+    std::vector<stbrp_rect> rects;
+    std::vector<std::pair<int, int>> aliases;   // (sprite, sprite it shares a rect with)
+    std::unordered_map<uint64_t, std::vector<int>> by_content;
+    for (int id = 0; id < sprite_count; ++id) {
+        const Sprite& tex = sprites[id];
+        if (tex.width == 0) continue;
 
-    // create atlas pixel buffer
-    const size_t stride = static_cast<size_t>(atlas.width) * 4;
-    std::vector<unsigned char> raw_data(static_cast<size_t>(atlas.height) * stride, 0);
+        const size_t bytes = static_cast<size_t>(tex.trim_w) * static_cast<size_t>(tex.trim_h) * 4;
+        auto& same = by_content[fnv1a(tex.data, bytes) ^ (static_cast<uint64_t>(tex.trim_w) << 32 | static_cast<uint64_t>(tex.trim_h))];
+        auto match = std::find_if(same.begin(), same.end(), [&](int other) {
+            const Sprite& o = sprites[other];
+            return o.trim_w == tex.trim_w && o.trim_h == tex.trim_h && std::memcmp(o.data, tex.data, bytes) == 0;
+        });
+        if (match != same.end()) {
+            aliases.push_back({id, *match});
+            continue;
+        }
+        same.push_back(id);
 
-    atlas.path = join_path_png(out_dir, "atlas");
+        stbrp_rect r = {};
+        r.id = id;
+        // the gutter goes around the sprite and the total keeps packed positions on multiples of the gutter
+        r.w  = (tex.trim_w + 3 * ATLAS_GUTTER - 1) / ATLAS_GUTTER * ATLAS_GUTTER;
+        r.h  = (tex.trim_h + 3 * ATLAS_GUTTER - 1) / ATLAS_GUTTER * ATLAS_GUTTER;
+        rects.push_back(r);
+    }
+    const AtlasLayout layout = choose_atlas_layout(rects);
+
+    atlas.width  = layout.width;
+    atlas.height = layout.height;
+    atlas.cache  = join_path_bin(out_dir, "atlas");
+    atlas.pixels.clear();
+    atlas.format = AtlasFormat::RGBA8;
+    atlas.palette.clear();
+
+    // Aliases are left out, their pixels are the same as the sprite they share a rect with.
+    if (ir.format == AtlasFormat::Indexed) {
+        std::vector<uint32_t> palette = {0};
+        PaletteLookup lookup;
+        bool fits = true;
+        for (size_t i = 0; i < rects.size() && fits; ++i) fits = gather_colours(palette, lookup, sprites[rects[i].id]);
+        if (fits) {
+            for (const stbrp_rect& r : rects) to_indices(sprites[r.id], lookup);
+            atlas.format  = AtlasFormat::Indexed;
+            atlas.palette = std::move(palette);
+        } else {
+            LOGSURA_WARN("Sprites use more than 255 colours, packing an RGBA8 atlas instead of an indexed one");
+        }
+    }
+    const int bpp = texel_bytes(atlas);
 
     ordered_json j;
     j["width"]       = atlas.width;
     j["height"]      = atlas.height;
-    j["true_width"]  = sizeX;
-    j["true_height"] = sizeY;
     j["rect_count"]  = rect_count;
     j["names_hash"]  = std::to_string(compute_resource_hash(kSpriteDefs));
+    j["mode"]        = std::to_underlying(ir.format);
+    j["format"]      = std::to_underlying(atlas.format);
+    j["palette"]     = atlas.palette;
+    j["pages"]       = 0;
     j["sprites"]     = ordered_json::object();
 
-    // blit each rect and fill json
-    for (int i = 0; i < rect_count; ++i) {
-        const stbrp_rect& rec = rects[static_cast<size_t>(i)];
-        Sprite& tex = sprites[rec.id];
-        tex.x = rec.x;
-        tex.y = rec.y;
+    std::vector<stbrp_node> nodes(static_cast<size_t>(atlas.width));
 
-        j["sprites"][tex.name] = {
-            {"x", tex.x}, {"y", tex.y},
-            {"w", tex.width}, {"h", tex.height}
-        };
+    // Pack as much as fits into a page, then spill whatever is left over into the next one.
+    std::vector<stbrp_rect> pending = rects;
+    std::vector<stbrp_rect> leftover;
+    while (!pending.empty()) {
+        const int page = static_cast<int>(atlas.pixels.size());
+
+        stbrp_context ctx;
+        stbrp_init_target(&ctx, atlas.width, atlas.height, nodes.data(), atlas.width);
+        stbrp_setup_heuristic(&ctx, layout.heuristic);
+        stbrp_pack_rects(&ctx, pending.data(), static_cast<int>(pending.size()));
+
+        // create page pixel buffer
+        std::vector<unsigned char> raw_data(page_bytes(atlas), 0);
+        leftover.clear();
 
-        for (int row = 0; row < rec.h; ++row) {
-            const unsigned char* src_row = tex.data + (static_cast<size_t>(row) * static_cast<size_t>(rec.w) * 4);
-            unsigned char* dest_row = raw_data.data() +
-               (static_cast<size_t>(rec.y + row) * static_cast<size_t>(atlas.width) + static_cast<size_t>(rec.x)) * 4;
-            std::memcpy(dest_row, src_row, static_cast<size_t>(rec.w) * 4);
+        // blit each rect and fill json
+        for (const stbrp_rect& rec : pending) {
+            if (!rec.was_packed) { leftover.push_back(rec); continue; }
+
+            Sprite& tex = sprites[rec.id];
+            tex.x = rec.x + ATLAS_GUTTER;
+            tex.y = rec.y + ATLAS_GUTTER;
+            tex.page = page;
+
+            j["sprites"][tex.name] = sprite_entry(tex);
+
+            blit(raw_data, atlas.width, bpp, tex);
+            if (tex.data) { stbi_image_free(tex.data); tex.data = nullptr; }
         }
-        if (tex.data) { stbi_image_free(tex.data); tex.data = nullptr; }
+
+        if (leftover.size() == pending.size()) {
+            const Sprite& tex = sprites[leftover.front().id];
+            die(std::format("Sprite {} ({}x{}) does not fit in a {}x{} atlas page", tex.name, tex.trim_w, tex.trim_h, atlas.width, atlas.height));
+        }
+
+        // the page goes to the GPU straight from memory, the cache only serves later runs
+        generate_mips(raw_data, atlas);
+        atlas.pixels.push_back(std::move(raw_data));
+        pending.swap(leftover);
     }
 
-    if (!stbi_write_png(atlas.path.c_str(), atlas.width, atlas.height, 4, raw_data.data(), atlas.width * 4)) {
-        die("Failed to write out atlas");
+    for (const auto& [id, original] : aliases) {
+        Sprite& tex = sprites[id];
+        tex.x    = sprites[original].x;
+        tex.y    = sprites[original].y;
+        tex.page = sprites[original].page;
+        j["sprites"][tex.name] = sprite_entry(tex);
+        if (tex.data) { stbi_image_free(tex.data); tex.data = nullptr; }
     }
 
+    atlas.page_count = static_cast<int>(atlas.pixels.size());
+    const double pack_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    write_atlas_cache(atlas);
+
+    uint64_t used = 0;
+    for (const stbrp_rect& r : rects) used += static_cast<uint64_t>(r.w) * static_cast<uint64_t>(r.h);
+    const uint64_t area = static_cast<uint64_t>(atlas.width) * static_cast<uint64_t>(atlas.height) * static_cast<uint64_t>(atlas.page_count);
+
+    j["pages"]   = atlas.page_count;
+    j["area"]    = area;
+    j["fill"]    = static_cast<double>(used) / static_cast<double>(area);
+    j["pack_ms"] = pack_ms;
     write_json_file(join_path_json(out_dir, "atlas"), j);
-    LOGSURA_INFO("Packaged images into: {}", atlas.path);
+    LOGSURA_INFO("Packaged images into {} {}x{} {} page(s) ({:.1f}% filled, {} duplicates shared) in {:.2f}ms at: {}",
+        atlas.page_count, atlas.width, atlas.height,
+        atlas.format == AtlasFormat::Indexed ? std::format("indexed ({} colours)", atlas.palette.size()) : std::string("RGBA8"),
+        100.0 * static_cast<double>(used) / static_cast<double>(area), aliases.size(), pack_ms, atlas.cache);
 }
 
 void Asura::Sprite::Renderer::_pack_images(const std::string &out_dir) {
@@ -131,82 +570,252 @@ void Asura::Sprite::Renderer::_pack_images(const std::string &out_dir) {
     for (int id = 0; id < sprite_count; ++id) if (sprites[id].width > 0) ++rect_count;
     if (rect_count == 0) return;
 
-    std::vector<stbrp_rect> rects(static_cast<size_t>(rect_count));
-    int k = 0, sizeX = 0, sizeY = 0;
+    const std::string json_path = join_path_json(out_dir, "atlas");
+    json data;
+
+    const bool have_meta = std::filesystem::exists(json_path) && read_json_file(json_path, data) &&
+                           data.contains("sprites") && data["sprites"].is_object() &&
+                           data.value("mode", 0u) == std::to_underlying(ir.format);
+
+    // With valid metadata and cache only the sprites that changed since the last run are touched.
+    bool reused = false;
+    if (have_meta) {
+        atlas.width      = data.value("width",  0);
+        atlas.height     = data.value("height", 0);
+        atlas.page_count = data.value("pages", 1);
+        atlas.format     = static_cast<AtlasFormat>(data.value("format", 0u));
+        atlas.palette    = data.value("palette", std::vector<uint32_t>{});
+        atlas.cache      = join_path_bin(out_dir, "atlas");
+        const bool palette_ok = atlas.format != AtlasFormat::Indexed || (!atlas.palette.empty() && atlas.palette.size() <= 256);
+        reused = palette_ok && read_atlas_cache(atlas) && _repack_changed(out_dir, data, rect_count);
+    }
+
+    if (!reused) {
+        std::vector<int> ids;
+        for (int id = 0; id < sprite_count; ++id) if (sprites[id].width > 0) ids.push_back(id);
+        _decode_images(out_dir, ids);
+        _pack({out_dir, rect_count});
+    }
+}
+
+bool Asura::Sprite::Renderer::_repack_changed(const std::string& out_dir, json& data, int rect_count) {
+    json& entries = data["sprites"];
+
+    // A sprite is a suspect when its file size, mtime or dimensions differ from what the metadata recorded.
+    std::vector<int> suspects, moved;
+    std::vector<bool> suspect(static_cast<size_t>(sprite_count), false);
+    std::set<std::string> names;
     for (int id = 0; id < sprite_count; ++id) {
-        Sprite& tex = sprites[id];
-        if (tex.width == 0) continue;
-        rects[k].id = id;
-        rects[k].w  = tex.width;
-        rects[k].h  = tex.height;
-        rects[k].x  = rects[k].y = 0;
-        rects[k].was_packed = 0;
-        sizeX += tex.width;
-        sizeY += tex.height;
-        ++k;
+        Sprite& s = sprites[id];
+        if (s.width == 0) continue;
+        names.insert(s.name);
+
+        if (!entries.contains(s.name)) {
+            suspects.push_back(id);
+            suspect[id] = true;
+            continue;
+        }
+        const json& e = entries[s.name];
+        s.x      = e.value("x", 0);
+        s.y      = e.value("y", 0);
+        s.page   = e.value("page", 0);
+        s.trim_x = e.value("tx", 0);
+        s.trim_y = e.value("ty", 0);
+        s.trim_w = e.value("tw", s.width);
+        s.trim_h = e.value("th", s.height);
+        if (e.value("w", -1) != s.width || e.value("h", -1) != s.height ||
+            e.value("size", uint64_t{0}) != s.fingerprint.size || e.value("mtime", int64_t{0}) != s.fingerprint.mtime) {
+            suspects.push_back(id);
+            suspect[id] = true;
+            continue;
+        }
+        s.fingerprint.hash = e.value("hash", uint64_t{0});
     }
 
-    const uint64_t awidth  = std::bit_ceil(static_cast<uint64_t>(sizeX));
-    const uint64_t aheight = std::bit_ceil(static_cast<uint64_t>(sizeY));
+    bool removed = false;
+    for (const auto& [name, e] : entries.items()) removed |= !names.contains(name);
 
-    const std::string json_path = join_path_json(out_dir, "atlas");
-    const std::string png_path  = join_path_png(out_dir,  "atlas");
-    json data;
+    if (suspects.empty() && !removed) {
+        LOGSURA_INFO("Reused atlas from metadata: {}", std::filesystem::relative(atlas.cache).string());
+        return true;
+    }
+    // past this point a full repack is cheaper, and it reports sprites that can't fit
+    if (suspects.size() * 2 > static_cast<size_t>(rect_count)) return false;
+    for (int id : suspects) {
+        if (sprites[id].width + 2 * ATLAS_GUTTER > atlas.width || sprites[id].height + 2 * ATLAS_GUTTER > atlas.height) return false;
+    }
 
-    const bool have_meta = std::filesystem::exists(json_path) && read_json_file(json_path, data);
+    _decode_images(out_dir, suspects);
 
-    bool can_reuse = false;
-    if (have_meta) {
-        const int  j_rect_count  = data.value("rect_count", -1);
-        const int  j_true_w      = data.value("true_width", -1);
-        const int  j_true_h      = data.value("true_height", -1);
-        const auto j_names_hash  = data.value("names_hash", std::string{});
-        const auto cur_hash      = std::to_string(compute_resource_hash(kSpriteDefs));
-
-        if (j_rect_count == rect_count &&
-            j_true_w == sizeX &&
-            j_true_h == sizeY &&
-            j_names_hash == cur_hash &&
-            std::filesystem::exists(png_path) &&
-            data.contains("sprites") && data["sprites"].is_object())
-        {
-            // Ensure every sprite has an entry
-            can_reuse = true;
-            for (int id = 0; id < sprite_count && can_reuse; ++id) {
-                Sprite& s = sprites[id];
-                if (s.width == 0) continue;
-                if (!data["sprites"].contains(s.name)) {
-                    can_reuse = false;
-                    break;
+    // New colours get new indices, so pages and palette swaps keep the ones they have. Nothing is touched before this.
+    if (atlas.format == AtlasFormat::Indexed) {
+        PaletteLookup lookup = palette_lookup(atlas.palette);
+        for (int id : suspects) {
+            if (!gather_colours(atlas.palette, lookup, sprites[id])) return false;
+        }
+        for (int id : suspects) to_indices(sprites[id], lookup);
+        data["palette"] = atlas.palette;
+    }
+    const int bpp = texel_bytes(atlas);
+
+    std::vector<AtlasRect> used, dirty;
+    for (int id = 0; id < sprite_count; ++id) {
+        const Sprite& s = sprites[id];
+        if (s.width > 0 && !suspect[id]) used.push_back(footprint(s));
+    }
+
+    // A rect can be shared by duplicate sprites, so it is only freed or redrawn when no unchanged sprite still uses it.
+    auto shared = [&used](const AtlasRect& r) {
+        return std::any_of(used.begin(), used.end(), [&r](const AtlasRect& u) { return u.page == r.page && u.x == r.x && u.y == r.y; });
+    };
+    auto old_rect = [](const json& e) -> AtlasRect {
+        return footprint(e.value("page", 0), e.value("x", 0), e.value("y", 0), e.value("tw", e.value("w", 0)), e.value("th", e.value("h", 0)));
+    };
+
+    // Free the old spots of removed and resized sprites first so new placements can reuse them.
+    for (const auto& [name, e] : entries.items()) {
+        if (names.contains(name)) continue;
+        const AtlasRect r = old_rect(e);
+        if (r.page >= atlas.page_count || shared(r)) continue;
+        clear(atlas.pixels[r.page], atlas.width, bpp, r);
+        dirty.push_back(r);
+    }
+
+    for (int id : suspects) {
+        Sprite& s = sprites[id];
+        const bool known = entries.contains(s.name);
+        if (known) {
+            const AtlasRect r = old_rect(entries[s.name]);
+            if (shared(r)) {
+                moved.push_back(id);
+                continue;
+            }
+            if (r.w == s.trim_w + 2 * ATLAS_GUTTER && r.h == s.trim_h + 2 * ATLAS_GUTTER) {
+                // same size: redraw in place, or nothing at all if only the mtime moved
+                used.push_back(r);
+                if (entries[s.name].value("hash", uint64_t{0}) != s.fingerprint.hash) {
+                    blit(atlas.pixels[r.page], atlas.width, bpp, s);
+                    dirty.push_back(r);
                 }
+                continue;
             }
+            clear(atlas.pixels[r.page], atlas.width, bpp, r);
+            dirty.push_back(r);
         }
+        moved.push_back(id);
     }
 
-    if (!can_reuse) {
-        _pack({sizeX, sizeY, rects, out_dir, rect_count, (int)awidth, (int)aheight});
-    } else {
-        atlas.path   = png_path;
-        atlas.width  = data.value("width",  0);
-        atlas.height = data.value("height", 0);
-
-        for (int id = 0; id < sprite_count; ++id) {
-            Sprite& s = sprites[id];
-            if (s.width == 0) continue;
-            auto& js = data["sprites"][s.name];
-            s.x = js.value("x", 0);
+    // Tallest first, each into the first page with room, growing a new page when none has any.
+    std::sort(moved.begin(), moved.end(), [this](int a, int b) { return sprites[a].trim_h > sprites[b].trim_h; });
+    const int old_pages = atlas.page_count;
+    for (int id : moved) {
+        Sprite& s = sprites[id];
+        bool placed = false;
+        for (int page = 0; page < atlas.page_count && !placed; ++page) {
+            placed = find_free_rect(used, page, atlas.width, atlas.height, s.trim_w + 2 * ATLAS_GUTTER, s.trim_h + 2 * ATLAS_GUTTER, s.x, s.y);
+            s.page = page;
+        }
+        if (!placed) {
+            atlas.pixels.emplace_back(page_bytes(atlas), 0);
+            s.page = atlas.page_count++;
+            s.x = s.y = 0;
         }
-        LOGSURA_INFO("Reused atlas from metadata: {}", std::filesystem::relative(atlas.path).string());
+        s.x += ATLAS_GUTTER;
+        s.y += ATLAS_GUTTER;
+        const AtlasRect r = footprint(s);
+        blit(atlas.pixels[r.page], atlas.width, bpp, s);
+        used.push_back(r);
+        dirty.push_back(r);
     }
+
+    for (int id : suspects) {
+        Sprite& s = sprites[id];
+        if (s.data) { stbi_image_free(s.data); s.data = nullptr; }
+        entries[s.name] = sprite_entry(s);
+    }
+    for (auto it = entries.begin(); it != entries.end();) {
+        if (names.contains(it.key())) ++it;
+        else it = entries.erase(it);
+    }
+
+    std::set<int> dirty_pages;
+    for (const AtlasRect& r : dirty) dirty_pages.insert(r.page);
+    for (int page : dirty_pages) generate_mips(atlas.pixels[page], atlas);
+
+    if (atlas.page_count != old_pages) write_atlas_cache(atlas);
+    else if (!dirty.empty()) patch_atlas_cache(atlas, dirty);
+
+    data["pages"] = atlas.page_count;
+    data["rect_count"] = rect_count;
+    write_json_file(join_path_json(out_dir, "atlas"), data);
+    LOGSURA_INFO("Updated {} sprite(s) in atlas: {}", suspects.size(), std::filesystem::relative(atlas.cache).string());
+    return true;
 }
 
+// Cuts fully transparent rows and columns off a decoded sprite, compacting its pixels in place.
+static void trim(Asura::Sprite::Sprite& tex) {
+    const auto alpha = [&tex](int x, int y) { return tex.data[(static_cast<size_t>(y) * static_cast<size_t>(tex.width) + static_cast<size_t>(x)) * 4 + 3]; };
+
+    int x0 = tex.width, y0 = tex.height, x1 = -1, y1 = -1;
+    for (int y = 0; y < tex.height; ++y) {
+        for (int x = 0; x < tex.width; ++x) {
+            if (alpha(x, y) == 0) continue;
+            x0 = std::min(x0, x); x1 = std::max(x1, x);
+            y0 = std::min(y0, y); y1 = std::max(y1, y);
+        }
+    }
+    // a fully transparent sprite still needs a texel to point at
+    if (x1 < 0) x0 = y0 = x1 = y1 = 0;
+
+    tex.trim_x = x0;
+    tex.trim_y = y0;
+    tex.trim_w = x1 - x0 + 1;
+    tex.trim_h = y1 - y0 + 1;
+    for (int row = 0; row < tex.trim_h; ++row) {
+        std::memmove(tex.data + static_cast<size_t>(row) * static_cast<size_t>(tex.trim_w) * 4,
+                     tex.data + (static_cast<size_t>(y0 + row) * static_cast<size_t>(tex.width) + static_cast<size_t>(x0)) * 4,
+                     static_cast<size_t>(tex.trim_w) * 4);
+    }
+}
+
+void Asura::Sprite::Renderer::_decode_images(const std::string& dir, const std::vector<int>& ids) {
+    // Each worker takes the next undecoded sprite until none are left; failures are reported once everyone is done.
+    std::atomic<size_t> next = 0;
+    std::atomic<bool> failed = false;
+    auto worker = [&]() {
+        for (size_t i = next++; i < ids.size(); i = next++) {
+            Sprite& tex = sprites[ids[i]];
+            if (tex.data) continue;
+            const auto bytes = readFileVec(join_path_png(dir, tex.name));
+            int w = 0, h = 0, n = 0;
+            tex.data = bytes.empty() ? nullptr : stbi_load_from_memory(bytes.data(), static_cast<int>(bytes.size()), &w, &h, &n, 4);
+            tex.fingerprint.hash = fnv1a(bytes.data(), bytes.size());
+            if (!tex.data || w != tex.width || h != tex.height) failed = true;
+            else trim(tex);
+        }
+    };
+
+    const size_t count = std::min<size_t>(ids.size(), std::max(1u, std::thread::hardware_concurrency()));
+    std::vector<std::thread> workers;
+    for (size_t t = 1; t < count; ++t) workers.emplace_back(worker);
+    worker();
+    for (std::thread& t : workers) t.join();
+
+    if (failed) {
+        for (int id : ids) {
+            if (!sprites[id].data) die(std::format("Failed to load image at: {}", join_path_png(dir, sprites[id].name)));
+        }
+        die("Sprite images changed while loading");
+    }
+    LOGSURA_DEBUG("Decoded {} images on {} thread(s)", ids.size(), count);
+}
 
 void Asura::Sprite::Renderer::_init_images(const char *dir) {
     sprite_count = 0;
     int highest_id = 0;
 
     sprites.clear();
-    sprites.resize(128);
+    sprites.resize(MAX_SPRITES);
 
     for (size_t i = 0; i < kSpriteDefs.size(); ++i) {
         const int id = kSpriteDefs[i].id;
@@ -216,14 +825,19 @@ void Asura::Sprite::Renderer::_init_images(const char *dir) {
 
         auto png = join_path_png(dir, kSpriteDefs[i].name);
 
+        // Only the header is read here; pixels are decoded later, and only if the atlas has to be rebuilt.
         int w = 0, h = 0, n = 0;
-        unsigned char* img = stbi_load(png.c_str(), &w, &h, &n, 4);
-        if (!img) die(std::format("Failed to load image at: {}", png));
+        if (!stbi_info(png.c_str(), &w, &h, &n)) die(std::format("Failed to load image at: {}", png));
         Sprite tex = {};
-        tex.width = w; tex.height = h; tex.channels = 4; tex.data = img;
+        tex.width = w; tex.height = h; tex.channels = 4; tex.data = nullptr;
+        tex.trim_w = w; tex.trim_h = h;
         tex.name = kSpriteDefs[i].name;
+
+        std::error_code ec;
+        tex.fingerprint.size  = std::filesystem::file_size(png, ec);
+        tex.fingerprint.mtime = std::filesystem::last_write_time(png, ec).time_since_epoch().count();
         sprites[id] = tex;
-        LOGSURA_DEBUG("Loaded image {} (enum id={})", kSpriteDefs[i].name, kSpriteDefs[i].id);
+        LOGSURA_DEBUG("Found image {} (enum id={})", kSpriteDefs[i].name, kSpriteDefs[i].id);
     }
 
     sprite_count = highest_id + 1;
@@ -238,62 +852,81 @@ inline Asura::Math::Vec2 get_tile_uv(Asura::Math::Vec2 tile_index, Asura::Math::
     };
 }
 
-void Asura::Sprite::Renderer::_init_ir(const std::string& path) {
-    ir.vs_params.mvp = Gfx::get_default_projection(Device::instance().high_dpi ? 2 : 1);
+void Asura::Sprite::Renderer::_init_ir() {
+    ir.projection = Gfx::get_default_projection(Device::instance().high_dpi ? 2 : 1);
+    ir.vs_params.mvp = ir.projection;
 
-    sg_shader shader = sg_make_shader(instance_shader_desc(sg_query_backend()));
-    int w, h;
-    unsigned char* pixels = stbi_load(path.c_str(), &w, &h, NULL, 4);
-
-    sg_image_desc img_desc = {};
-    img_desc.width  = w;
-    img_desc.height = h;
-    img_desc.data.mip_levels[0].ptr = pixels;
-    img_desc.data.mip_levels[0].size = static_cast<size_t>(w * h * 4);
-    sg_image image = sg_make_image(&img_desc);
+    const bool indexed = atlas.format == AtlasFormat::Indexed;
+    sg_shader shader = sg_make_shader(indexed ? instance_indexed_shader_desc(sg_query_backend()) : instance_shader_desc(sg_query_backend()));
 
-    stbi_image_free(pixels);
+    if (atlas.pixels.size() > MAX_ATLAS_PAGES) {
+        die(std::format("Sprite atlas has {} pages, sort keys tell at most {} apart", atlas.pixels.size(), MAX_ATLAS_PAGES));
+    }
 
-    ir.width  = w;
-    ir.height = h;
+    // every page has the same size, so the frame table can share one atlas size
+    ir.pages.clear();
+    for (const auto& pixels : atlas.pixels) {
+        sg_image_desc img_desc = {};
+        img_desc.width  = atlas.width;
+        img_desc.height = atlas.height;
+        img_desc.num_mipmaps = page_levels(atlas);
+        if (indexed) {
+            img_desc.pixel_format = SG_PIXELFORMAT_R8;
+            img_desc.data.mip_levels[0] = { pixels.data(), pixels.size() };
+        } else {
+            for (int level = 0; level < img_desc.num_mipmaps; ++level) {
+                img_desc.data.mip_levels[level].ptr  = pixels.data() + mip_offset(atlas.width, atlas.height, level);
+                img_desc.data.mip_levels[level].size = mip_offset(atlas.width, atlas.height, level + 1) - mip_offset(atlas.width, atlas.height, level);
+            }
+        }
+        sg_image image = sg_make_image(&img_desc);
 
-    sg_sampler_desc smp_desc = {};
-    smp_desc.min_filter = SG_FILTER_LINEAR;
-    smp_desc.mag_filter = SG_FILTER_NEAREST;
-    sg_sampler smp = sg_make_sampler(&smp_desc);
+        sg_view_desc view_desc = {};
+        view_desc.texture.image = image;
+        ir.pages.push_back(sg_make_view(&view_desc));
+    }
+    ir.width  = atlas.width;
+    ir.height = atlas.height;
+    atlas.pixels.clear();
+    atlas.pixels.shrink_to_fit();
+    _init_frames();
 
     ir.bindings.vertex_buffers[0] = make_unit_vbuf();
     ir.bindings.index_buffer = make_ibuf();
-    sg_view_desc view_desc = {};
-    view_desc.texture.image = image;
-    ir.bindings.views[VIEW_inst_tex] = sg_make_view(&view_desc);
+    if (!ir.pages.empty()) ir.bindings.views[VIEW_inst_tex] = ir.pages[0];
 
-    ir.bindings.samplers[SMP_inst_smp] = smp;
+    if (indexed) {
+        ir.palettes.assign(static_cast<size_t>(256) * MAX_PALETTES, 0);
+        for (size_t row = 0; row < MAX_PALETTES; ++row) std::copy(atlas.palette.begin(), atlas.palette.end(), ir.palettes.begin() + row * 256);
+        _upload_palettes();
+    }
 
-    sg_buffer_desc vbuf_desc = {};
-    vbuf_desc.size = sizeof(InstanceData) * MAX_INSTANCES;
-    vbuf_desc.usage.stream_update = true;
-    vbuf_desc.usage.vertex_buffer = true;
-    vbuf_desc.label = "instance-buffer";
-    ir.bindings.vertex_buffers[1] = sg_make_buffer(&vbuf_desc);
+    _make_sampler();
+
+    ir.chunks.clear();
+    ir.ring = {};
+    _grow_chunks(1);
+    ir.bindings.vertex_buffers[1] = ir.chunks[0];
 
     sg_pipeline_desc pip_desc = {};
     pip_desc.shader = shader;
     pip_desc.index_type = SG_INDEXTYPE_UINT16;
     pip_desc.layout.buffers[0].stride = 4 * sizeof(float);
-    pip_desc.layout.buffers[1].stride = sizeof(InstanceData);
+    pip_desc.layout.buffers[1].stride = static_cast<int>(ir.stride);
     pip_desc.layout.buffers[1].step_func = SG_VERTEXSTEP_PER_INSTANCE;
     // attrs follows buffer_idx, offset, format
     pip_desc.layout.attrs[ATTR_instance_aPos] = { 0, 0, SG_VERTEXFORMAT_FLOAT2 };
     pip_desc.layout.attrs[ATTR_instance_aUV]  = { 0, 2 * (int)sizeof(float), SG_VERTEXFORMAT_FLOAT2 };
 
-    pip_desc.layout.attrs[ATTR_instance_aOffset]     = { 1, offsetir(offset),     SG_VERTEXFORMAT_FLOAT2, };
-    pip_desc.layout.attrs[ATTR_instance_aUVOffset]   = { 1, offsetir(uvOffset),   SG_VERTEXFORMAT_FLOAT2, };
-    pip_desc.layout.attrs[ATTR_instance_aWorldScale] = { 1, offsetir(worldScale), SG_VERTEXFORMAT_FLOAT2, };
-    pip_desc.layout.attrs[ATTR_instance_aUVScale]    = { 1, offsetir(uvScale),    SG_VERTEXFORMAT_FLOAT2, };
-    pip_desc.layout.attrs[ATTR_instance_aRotation]   = { 1, offsetir(rotation),   SG_VERTEXFORMAT_FLOAT,  };
-    pip_desc.layout.attrs[ATTR_instance_aPivot]      = { 1, offsetir(pivot),      SG_VERTEXFORMAT_FLOAT2, };
-    pip_desc.layout.attrs[ATTR_instance_aTint]       = { 1, offsetir(tint),       SG_VERTEXFORMAT_FLOAT4, };
+    if (ir.layout == InstanceLayout::Compact) {
+        pip_desc.layout.attrs[ATTR_instance_aOffset]   = { 1, offsetcir(offset),   SG_VERTEXFORMAT_FLOAT2,  };
+        pip_desc.layout.attrs[ATTR_instance_aScaleRot] = { 1, offsetcir(scaleRot), SG_VERTEXFORMAT_HALF4,   };
+        pip_desc.layout.attrs[ATTR_instance_aTint]     = { 1, offsetcir(tint),     SG_VERTEXFORMAT_UBYTE4N, };
+    } else {
+        pip_desc.layout.attrs[ATTR_instance_aOffset]   = { 1, offsetir(offset), SG_VERTEXFORMAT_FLOAT2, };
+        pip_desc.layout.attrs[ATTR_instance_aScaleRot] = { 1, offsetir(scale),  SG_VERTEXFORMAT_FLOAT4, };
+        pip_desc.layout.attrs[ATTR_instance_aTint]     = { 1, offsetir(tint),   SG_VERTEXFORMAT_FLOAT4, };
+    }
 
     pip_desc.colors[0].blend.enabled          = true;
     pip_desc.colors[0].blend.src_factor_rgb   = SG_BLENDFACTOR_SRC_ALPHA;
@@ -305,30 +938,423 @@ void Asura::Sprite::Renderer::_init_ir(const std::string& path) {
 
     pip_desc.label = "instance-pipeline";
 
-    ir.pipeline = sg_make_pipeline(&pip_desc);
+    ir.pipelines[std::to_underlying(Blend::Alpha)] = sg_make_pipeline(&pip_desc);
+
+    pip_desc.colors[0].blend.dst_factor_rgb   = SG_BLENDFACTOR_ONE;
+    pip_desc.colors[0].blend.dst_factor_alpha = SG_BLENDFACTOR_ONE;
+    pip_desc.label = "instance-pipeline-additive";
 
-    ir.instances.clear();
+    ir.pipelines[std::to_underlying(Blend::Additive)] = sg_make_pipeline(&pip_desc);
+
+    _clear();
+    LOGSURA_DEBUG("Sprite instance layout: {} bytes per instance", ir.stride);
 }
 
-void Asura::Sprite::Renderer::_push_instance(int id, Math::Vec2 position, Math::Vec2 scale, float rotation, Math::Vec2 pivot, Math::Vec2 pivot_px, Math::Vec4 tint) {
-    if (ir.instances.size() < MAX_INSTANCES) {
-        Sprite& tex = sprites[id];
-        ir.instances.push_back(_create_instance_data({tex, position, scale, rotation, pivot, pivot_px, tint}));
+std::span<const uint32_t> Asura::Sprite::Renderer::palette(int row) const {
+    if (ir.palettes.empty() || row < 0 || row >= MAX_PALETTES) return {};
+    return {ir.palettes.data() + static_cast<size_t>(row) * 256, atlas.palette.size()};
+}
+
+void Asura::Sprite::Renderer::set_palette(int row, std::span<const uint32_t> colours) {
+    if (ir.palettes.empty()) {
+        LOGSURA_WARN("Sprite palettes need an indexed atlas, ignoring set_palette({})", row);
+        return;
     }
+    if (row < 0 || row >= MAX_PALETTES || colours.size() > 256) {
+        LOGSURA_WARN("Sprite palette row {} with {} colours is out of range, ignoring set_palette()", row, colours.size());
+        return;
+    }
+    std::copy(colours.begin(), colours.end(), ir.palettes.begin() + static_cast<ptrdiff_t>(row) * 256);
+    _upload_palettes();
+}
+
+// Shared by Renderer and Recorder, so a bad row is treated the same whichever is asked.
+static bool valid_palette_row(int row) {
+    if (row >= 0 && row < MAX_PALETTES) return true;
+    LOGSURA_WARN("Sprite palette row {} is out of range, ignoring use_palette()", row);
+    return false;
+}
+
+void Asura::Sprite::Renderer::use_palette(int row) {
+    if (valid_palette_row(row)) ir.palette = row;
 }
 
-void Asura::Sprite::Renderer::_update_ir(Math::Mat4 projection, Math::Mat4 view) {
-    sg_range range = { .ptr = ir.instances.data(), .size = ir.instances.size() * sizeof(InstanceData) };
-    sg_update_buffer(ir.bindings.vertex_buffers[1], &range);
+void Asura::Sprite::Recorder::use_palette(int row) {
+    if (valid_palette_row(row)) palette = row;
+}
+
+void Asura::Sprite::Renderer::_upload_palettes() {
+    // Palettes change rarely (team colours are set up once), so the texture is remade rather than kept dynamic.
+    if (ir.palette_image.id != SG_INVALID_ID) {
+        sg_destroy_view(ir.bindings.views[VIEW_inst_palette]);
+        sg_destroy_image(ir.palette_image);
+    }
+
+    sg_image_desc img_desc = {};
+    img_desc.width  = 256;
+    img_desc.height = MAX_PALETTES;
+    img_desc.pixel_format = SG_PIXELFORMAT_RGBA8;
+    img_desc.data.mip_levels[0] = { ir.palettes.data(), ir.palettes.size() * sizeof(uint32_t) };
+    img_desc.label = "sprite-palettes";
+    ir.palette_image = sg_make_image(&img_desc);
+
+    sg_view_desc view_desc = {};
+    view_desc.texture.image = ir.palette_image;
+    ir.bindings.views[VIEW_inst_palette] = sg_make_view(&view_desc);
+}
+
+void Asura::Sprite::Renderer::set_mipmap_filter(sg_filter filter) {
+    ir.mipmap_filter = filter;
+    if (ir.bindings.samplers[SMP_inst_smp].id != SG_INVALID_ID) _make_sampler();
+}
+
+void Asura::Sprite::Renderer::_make_sampler() {
+    if (ir.bindings.samplers[SMP_inst_smp].id != SG_INVALID_ID) sg_destroy_sampler(ir.bindings.samplers[SMP_inst_smp]);
+
+    // indices can't be blended, so an indexed atlas is always sampled nearest
+    sg_sampler_desc smp_desc = {};
+    smp_desc.min_filter = atlas.format == AtlasFormat::Indexed ? SG_FILTER_NEAREST : SG_FILTER_LINEAR;
+    smp_desc.mag_filter = SG_FILTER_NEAREST;
+    smp_desc.mipmap_filter = ir.mipmap_filter;
+    ir.bindings.samplers[SMP_inst_smp] = sg_make_sampler(&smp_desc);
+}
+
+void Asura::Sprite::Renderer::_init_frames() {
+    ir.frames = {};
+    ir.frames.atlas_size = {static_cast<float>(ir.width), static_cast<float>(ir.height), 0, 0};
+    ir.sizes.assign(MAX_SPRITES, {0, 0});
+    ir.trims.assign(MAX_SPRITES, {0, 0, 0, 0});
+    for (int id = 0; id < sprite_count && id < MAX_SPRITES; ++id) {
+        const Sprite& tex = sprites[id];
+        if (tex.width == 0) continue;
+        ir.sizes[id] = {static_cast<float>(tex.width), static_cast<float>(tex.height)};
+        ir.trims[id] = {static_cast<float>(tex.trim_x), static_cast<float>(tex.trim_y), static_cast<float>(tex.trim_w), static_cast<float>(tex.trim_h)};
+        ir.frames.frames[id] = {
+            tex.x      / static_cast<float>(ir.width),
+            tex.y      / static_cast<float>(ir.height),
+            tex.trim_w / static_cast<float>(ir.width),
+            tex.trim_h / static_cast<float>(ir.height)
+        };
+    }
+}
+
+void Asura::Sprite::Renderer::_grow_chunks(size_t count) {
+    while (ir.chunks.size() < count) {
+        sg_buffer_desc vbuf_desc = {};
+        vbuf_desc.size = ir.stride * MAX_INSTANCES_PER_CHUNK;
+        vbuf_desc.usage.stream_update = true;
+        vbuf_desc.usage.vertex_buffer = true;
+        vbuf_desc.label = "instance-buffer";
+        ir.chunks.push_back(sg_make_buffer(&vbuf_desc));
+        LOGSURA_DEBUG("Allocated sprite instance chunk #{}", ir.chunks.size());
+    }
+    ir.stats.chunks = static_cast<int>(ir.chunks.size());
+}
+
+// Maps a float to an unsigned int that sorts in the same order.
+static uint32_t depth_bits(float depth) {
+    const uint32_t u = std::bit_cast<uint32_t>(depth);
+    return (u & 0x80000000u) ? ~u : u | 0x80000000u;
+}
+
+// layer:16 | page:8 | blend:8 | depth:32
+static uint64_t sort_key(int page, const Asura::Sprite::Order& order) {
+    return static_cast<uint64_t>(order.layer) << 48
+         | static_cast<uint64_t>(page) << 40  // below MAX_ATLAS_PAGES, checked at init
+         | static_cast<uint64_t>(std::to_underlying(order.blend)) << 32
+         | depth_bits(order.depth);
+}
+
+void Asura::Sprite::Renderer::_push_instance(int id, Math::Vec2 position, Math::Vec2 scale, float rotation, Math::Vec2 pivot, Math::Vec2 pivot_px, Math::Vec4 tint, const Order& order) {
+    Sprite& tex = sprites[id];
+    ir.instances.push_back(_create_instance_data({tex, id, position, scale, rotation, pivot, pivot_px, tint, ir.palette}));
+    ir.keys.push_back(sort_key(tex.page, order));
+}
+
+void Asura::Sprite::Recorder::_push_instance(int id, Math::Vec2 position, Math::Vec2 scale, float rotation, Math::Vec2 pivot, Math::Vec2 pivot_px, Math::Vec4 tint, const Order& order) {
+    const Sprite& tex = owner.sprites[id];
+    instances.push_back(owner._create_instance_data({tex, id, position, scale, rotation, pivot, pivot_px, tint, palette}));
+    keys.push_back(sort_key(tex.page, order));
+}
+
+Asura::Sprite::Recorder& Asura::Sprite::Renderer::recorder(size_t index) {
+    while (ir.recorders.size() <= index) ir.recorders.push_back(std::make_unique<Recorder>(*this));
+    return *ir.recorders[index];
+}
+
+void Asura::Sprite::Renderer::_merge_recorders() {
+    size_t total = ir.instances.size();
+    for (const auto& rec : ir.recorders) total += rec->instances.size();
+    ir.instances.reserve(total);
+    ir.keys.reserve(total);
+
+    for (const auto& rec : ir.recorders) {
+        ir.instances.insert(ir.instances.end(), rec->instances.begin(), rec->instances.end());
+        ir.keys.insert(ir.keys.end(), rec->keys.begin(), rec->keys.end());
+        rec->instances.clear();
+        rec->keys.clear();
+    }
+}
+
+void Asura::Sprite::Renderer::_push_many(std::span<const int> ids, std::span<const Math::Vec2> positions, std::span<const Math::Vec2> scales,
+                                         std::span<const float> rotations, std::span<const Math::Vec4> tints, Math::Vec2 pivot, const Order& order) {
+    const size_t n = ids.size();
+    if (n == 0) return;
+
+    // A span either has one entry per sprite (stride 1) or a single value shared by all of them (stride 0).
+    auto stride = [n](size_t size, const char* name) -> size_t {
+        if (size > 1 && size != n) die(std::format("Sprite push_many: {} has {} entries for {} sprites", name, size, n));
+        return size > 1 ? 1 : 0;
+    };
+    static const Math::Vec2 one_scale = {1, 1};
+    static const float zero_rotation = 0.f;
+    static const Math::Vec4 white = {1, 1, 1, 1};
+
+    const size_t ps = stride(positions.size(), "positions");
+    const size_t ss = stride(scales.size(), "scales");
+    const size_t rs = stride(rotations.size(), "rotations");
+    const size_t ts = stride(tints.size(), "tints");
+    if (positions.empty()) die("Sprite push_many: positions is empty");
+
+    const Math::Vec2* pos = positions.data();
+    const Math::Vec2* scl = scales.empty() ? &one_scale : scales.data();
+    const float* rot      = rotations.empty() ? &zero_rotation : rotations.data();
+    const Math::Vec4* tnt = tints.empty() ? &white : tints.data();
+
+    const size_t base = ir.instances.size();
+    ir.instances.resize(base + n);
+    ir.keys.resize(base + n);
+    InstanceData* out = ir.instances.data() + base;
+    uint64_t* keys = ir.keys.data() + base;
+
+    const Math::Vec2* sizes = ir.sizes.data();
+    const Math::Vec4* trims = ir.trims.data();
+    const uint64_t key = sort_key(0, order);
+    const int palette = MAX_SPRITES * ir.palette;
+    const float c0 = std::cos(*rot), s0 = std::sin(*rot);
+
+    // Same result as _create_instance_data, without the per-sprite call, lookup through Sprite and push_back.
+    for (size_t i = 0; i < n; ++i) {
+        const int id = ids[i];
+        const Math::Vec2 scale = scl[i * ss];
+        const float rotation = rot[i * rs];
+        const float c = rs ? std::cos(rotation) : c0;
+        const float s = rs ? std::sin(rotation) : s0;
+
+        const float px = (pivot.x * sizes[id].x - trims[id].x) * scale.x;
+        const float py = (pivot.y * sizes[id].y - trims[id].y) * scale.y;
+
+        InstanceData& in = out[i];
+        in.offset   = {pos[i * ps].x - (c * px + s * py), pos[i * ps].y - (-s * px + c * py)};
+        in.scale    = scale;
+        in.rotation = rotation;
+        in.frame    = static_cast<float>(id + palette);
+        in.tint     = tnt[i * ts];
+        keys[i]     = key | static_cast<uint64_t>(sprites[id].page) << 40;
+    }
+}
+
+void Asura::Sprite::Renderer::_pack_compact(const InstanceData* src, size_t count) {
+    ir.packed.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        const InstanceData& in = src[i];
+        CompactInstanceData& out = ir.packed[i];
+
+        // half precision falls apart for large angles, so keep rotation in [-pi, pi]
+        const float rot = std::remainder(in.rotation, 2.f * static_cast<float>(Math::pi));
+
+        out.offset      = in.offset;
+        out.scaleRot[0] = Math::to_half(in.scale.x);
+        out.scaleRot[1] = Math::to_half(in.scale.y);
+        out.scaleRot[2] = Math::to_half(rot);
+        out.scaleRot[3] = Math::to_half(in.frame);
+        out.tint        = Utils::Gfx::rgba8(in.tint);
+    }
+}
+
+void Asura::Sprite::Renderer::_cull() {
+    /*
+     * Same transform as vs_inst, reduced to bounds: the quad spans [0, world_scale] rotated about the offset, so
+     * whatever the rotation it stays inside the disc around the offset whose radius is the quad's diagonal. That
+     * bound needs no trig, at the cost of keeping a few sprites just off screen. Sprite projections are affine, so
+     * the disc maps into clip space with the 2x2 part of the mvp plus its translation, its extent along each clip
+     * axis being the radius times the length of that row. The first pass is branch-free over the whole array; the
+     * second compacts the survivors in push order.
+     */
+    const Math::Mat4& m = ir.vs_params.mvp;
+    const float m00 = m(0, 0), m01 = m(0, 1), m03 = m(0, 3);
+    const float m10 = m(1, 0), m11 = m(1, 1), m13 = m(1, 3);
+    const float row_x = std::sqrt(m00 * m00 + m01 * m01);
+    const float row_y = std::sqrt(m10 * m10 + m11 * m11);
+
+    const size_t count = ir.instances.size();
+    const InstanceData* inst = ir.instances.data();
+    const Math::Vec4* trims = ir.trims.data();
+    ir.visible.resize(count);
+    uint8_t* visible = ir.visible.data();
+
+    for (size_t i = 0; i < count; ++i) {
+        const InstanceData& in = inst[i];
+        const Math::Vec4& trim = trims[static_cast<int>(in.frame) % MAX_SPRITES];
+        const float w = trim.z * in.scale.x;
+        const float h = trim.w * in.scale.y;
+        const float r = std::sqrt(w * w + h * h);
+
+        const float nx  = m00 * in.offset.x + m01 * in.offset.y + m03;
+        const float ny  = m10 * in.offset.x + m11 * in.offset.y + m13;
+        const float enx = r * row_x;
+        const float eny = r * row_y;
+
+        visible[i] = (nx - enx <= 1.f) & (nx + enx >= -1.f) & (ny - eny <= 1.f) & (ny + eny >= -1.f);
+    }
+
+    size_t kept = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (!visible[i]) continue;
+        ir.instances[kept] = ir.instances[i];
+        ir.keys[kept] = ir.keys[i];
+        ++kept;
+    }
+    ir.instances.resize(kept);
+    ir.keys.resize(kept);
+    ir.stats.culled = count - kept;
+}
+
+bool Asura::Sprite::Renderer::_sort_by_key() {
+    /*
+     * LSD radix sort over the 64-bit keys, one byte per pass. Every pass is a stable counting sort, so push order
+     * survives between equal keys. Bytes that are the same for every instance (usually most of them) are skipped,
+     * and all scratch buffers are reused between frames.
+     */
+    const size_t count = ir.keys.size();
+    size_t histogram[8][256] = {};
+    for (const uint64_t key : ir.keys) {
+        for (int pass = 0; pass < 8; ++pass) histogram[pass][(key >> (pass * 8)) & 0xff]++;
+    }
+
+    ir.indices.resize(count);
+    ir.indices_tmp.resize(count);
+    ir.keys_tmp.resize(count);
+    for (size_t i = 0; i < count; ++i) ir.indices[i] = static_cast<uint32_t>(i);
+
+    bool sorted = false;
+    for (int pass = 0; pass < 8; ++pass) {
+        size_t* buckets = histogram[pass];
+        if (buckets[(ir.keys[0] >> (pass * 8)) & 0xff] == count) continue;
+
+        size_t sum = 0;
+        for (int b = 0; b < 256; ++b) {
+            const size_t n = buckets[b];
+            buckets[b] = sum;
+            sum += n;
+        }
+        for (size_t i = 0; i < count; ++i) {
+            const size_t dst = buckets[(ir.keys[i] >> (pass * 8)) & 0xff]++;
+            ir.keys_tmp[dst] = ir.keys[i];
+            ir.indices_tmp[dst] = ir.indices[i];
+        }
+        ir.keys.swap(ir.keys_tmp);
+        ir.indices.swap(ir.indices_tmp);
+        sorted = true;
+    }
+    if (!sorted) return false;
+
+    ir.sorted.resize(count);
+    for (size_t i = 0; i < count; ++i) ir.sorted[i] = ir.instances[ir.indices[i]];
+    return true;
+}
+
+// Whether this is the first render() since the last frame ended; sokol rewinds the append cursors with every frame.
+bool Asura::Sprite::Renderer::_new_frame() {
+    const uint64_t now = Device::instance().frame;
+    if (ir.frame == now) return false;
+    ir.frame = now;
+    return true;
+}
+
+void Asura::Sprite::Renderer::_update_ir(Math::Mat4 view) {
+    ir.batches.clear();
+    ir.vs_params.mvp = ir.projection * view;
     ir.dirty = false;
-    ir.vs_params.mvp = projection * view;
+    ir.stats.culled = 0;
+
+    _merge_recorders();
+    if (ir.culling) _cull();
+
+    const size_t count = ir.instances.size();
+    if (count == 0) return;
+
+    if (_new_frame()) {
+        ir.ring = {};
+        ir.stats.renders = 0;
+        ir.stats.bytes = 0;
+    }
+    ++ir.stats.renders;
+
+    // Sorting by key groups instances by page and blend, so each group costs as few draws as possible.
+    const InstanceData* inst = ir.instances.data();
+    if (_sort_by_key()) inst = ir.sorted.data();
+
+    const auto* src = reinterpret_cast<const uint8_t*>(inst);
+    if (ir.layout == InstanceLayout::Compact) {
+        _pack_compact(inst, count);
+        src = reinterpret_cast<const uint8_t*>(ir.packed.data());
+    }
+
+    size_t first = 0;
+    while (first < count) {
+        // a run shares page and blend (the middle 16 bits of the key)
+        const uint64_t group = (ir.keys[first] >> 32) & 0xffff;
+        size_t end = first + 1;
+        while (end < count && ((ir.keys[end] >> 32) & 0xffff) == group) ++end;
+
+        const size_t page = group >> 8;
+        const auto blend = static_cast<Blend>(group & 0xff);
+        while (first < end) {
+            if (ir.ring.used == MAX_INSTANCES_PER_CHUNK) {
+                ir.ring.chunk++;
+                ir.ring.used = 0;
+            }
+            _grow_chunks(ir.ring.chunk + 1);
+
+            const size_t n = std::min<size_t>(end - first, MAX_INSTANCES_PER_CHUNK - ir.ring.used);
+            sg_range range = { .ptr = src + first * ir.stride, .size = n * ir.stride };
+            int offset = sg_append_buffer(ir.chunks[ir.ring.chunk], &range);
+            ir.stats.bytes += range.size;
+
+            ir.batches.push_back({ir.ring.chunk, page, blend, offset, static_cast<int>(n)});
+            ir.ring.used += n;
+            first += n;
+        }
+    }
 }
 
-void Asura::Sprite::Renderer::_draw_ir() const {
-    if (ir.instances.size() == 0) return;
-    sg_apply_pipeline(ir.pipeline);
-    sg_apply_bindings(&ir.bindings);
-    sg_apply_uniforms(UB_instance_params, SG_RANGE(ir.vs_params));
+void Asura::Sprite::Renderer::_draw_ir() {
+    ir.stats.instances = ir.instances.size();
+    ir.stats.draws = 0;
+    if (ir.batches.empty()) return;
 
-    sg_draw(0, 6, ir.instances.size());
+    bool applied = false;
+    Blend blend = Blend::Alpha;
+    for (const Batch& b : ir.batches) {
+        // uniforms don't survive a pipeline switch, so they go again after every apply
+        const bool switched = !applied || b.blend != blend;
+        if (switched) {
+            blend = b.blend;
+            applied = true;
+            sg_apply_pipeline(ir.pipelines[std::to_underlying(blend)]);
+        }
+
+        ir.bindings.vertex_buffers[1] = ir.chunks[b.chunk];
+        ir.bindings.vertex_buffer_offsets[1] = b.offset;
+        ir.bindings.views[VIEW_inst_tex] = ir.pages[b.page];
+        sg_apply_bindings(&ir.bindings);
+        if (switched) {
+            sg_apply_uniforms(UB_instance_params, SG_RANGE(ir.vs_params));
+            sg_apply_uniforms(UB_instance_frames, SG_RANGE(ir.frames));
+        }
+
+        sg_draw(0, 6, b.count);
+        ++ir.stats.draws;
+    }
 }